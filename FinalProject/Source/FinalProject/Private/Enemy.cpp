@@ -6,6 +6,8 @@
 #include "Survivor.h"
 #include "GameHUD.h"
 #include "TopDownGameMode.h"
+#include "FixedStepSubsystem.h"
+#include "RandomStreamSubsystem.h"
 #include "Components/ProgressBar.h"
 
 AEnemy::AEnemy()
@@ -86,25 +88,46 @@ void AEnemy::BeginPlay()
     {
         SpawnDefaultController();
     }
+
+    if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+    {
+        FixedStepHandle = FixedStep->OnFixedStep.AddUObject(this, &AEnemy::FixedTick);
+    }
+}
+
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+    {
+        FixedStep->OnFixedStep.Remove(FixedStepHandle);
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 void AEnemy::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
     
+    // Movement input is consumed every frame, so keep feeding the last simulated direction
+    if (!MoveDirection.IsZero())
+    {
+        AddMovementInput(MoveDirection, 1.0f);
+    }
+}
+
+void AEnemy::FixedTick(float StepSeconds)
+{
     // Basic movement - just move towards player
     if (APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0))
     {
         FVector ToPlayer = PlayerPawn->GetActorLocation() - GetActorLocation();
         ToPlayer.Z = 0.0f; // Keep movement on plane
         float DistanceToPlayer = ToPlayer.Size();
-        ToPlayer.Normalize();
-        
-        // Move towards player
-        AddMovementInput(ToPlayer, 1.0f);
+        MoveDirection = ToPlayer.GetSafeNormal();
 
-        // Check if we can damage player
-        float CurrentTime = GetWorld()->GetTimeSeconds();
+        // Check if we can damage player, using simulated time so the cooldown doesn't depend on frame rate
+        float CurrentTime = GetWorld()->GetSubsystem<UFixedStepSubsystem>()->GetSimTime();
         if (DistanceToPlayer <= DamageRadius && CurrentTime - LastDamageTime >= DamageCooldown)
         {
             // Apply damage to player
@@ -112,6 +135,10 @@ void AEnemy::Tick(float DeltaTime)
             LastDamageTime = CurrentTime;
         }
     }
+    else
+    {
+        MoveDirection = FVector::ZeroVector;
+    }
 }
 
 void AEnemy::UpdateHealthBar()
@@ -146,8 +173,12 @@ float AEnemy::TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AC
         GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
         GetCharacterMovement()->StopMovementImmediately();
         
+        // Rolls come from the seeded drop channel so benchmark runs and replays get the same drops
+        URandomStreamSubsystem* Random = UGameInstance::GetSubsystem<URandomStreamSubsystem>(GetGameInstance());
+        check(Random);
+
         // 70% chance to give a power-up
-        if (FMath::RandRange(0.0f, 1.0f) <= 0.7f)
+        if (Random->FRandRange(URandomStreamSubsystem::DropChannel, 0.0f, 1.0f) <= 0.7f)
         {
             // Get player reference
             if (ASurvivor* Player = Cast<ASurvivor>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0)))
@@ -191,7 +222,7 @@ float AEnemy::TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AC
                 // Select a random power-up from remaining options
                 if (AvailablePowerUps.Num() > 0)
                 {
-                    int32 RandomIndex = FMath::RandRange(0, AvailablePowerUps.Num() - 1);
+                    int32 RandomIndex = Random->RandRange(URandomStreamSubsystem::DropChannel, 0, AvailablePowerUps.Num() - 1);
                     EPowerUpType SelectedPowerUp = AvailablePowerUps[RandomIndex];
 
                     // Apply power-up effects directly
@@ -204,13 +235,13 @@ float AEnemy::TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AC
                             Player->GetCharacterMovement()->MaxWalkSpeed *= 1.5f;
                             GetWorld()->GetTimerManager().SetTimer(
                                 PowerUpTimerHandle,
-                                [Player]()
+                                FTimerDelegate::CreateWeakLambda(Player, [Player]()
                                 {
                                     if (IsValid(Player))
                                     {
                                         Player->GetCharacterMovement()->MaxWalkSpeed /= 1.5f;
                                     }
-                                },
+                                }),
                                 PowerUpDuration,
                                 false);
                             break;
@@ -219,13 +250,13 @@ float AEnemy::TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AC
                             Player->DamageMultiplier = 2.0f;
                             GetWorld()->GetTimerManager().SetTimer(
                                 PowerUpTimerHandle,
-                                [Player]()
+                                FTimerDelegate::CreateWeakLambda(Player, [Player]()
                                 {
                                     if (IsValid(Player))
                                     {
                                         Player->DamageMultiplier = 1.0f;
                                     }
-                                },
+                                }),
                                 PowerUpDuration,
                                 false);
                             break;
@@ -234,13 +265,13 @@ float AEnemy::TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AC
                             Player->ModifyFireRate(0.5f);  // Reduce fire rate by half
                             GetWorld()->GetTimerManager().SetTimer(
                                 PowerUpTimerHandle,
-                                [Player]()
+                                FTimerDelegate::CreateWeakLambda(Player, [Player]()
                                 {
                                     if (IsValid(Player))
                                     {
                                         Player->ModifyFireRate(1.0f, true);  // Reset to original fire rate
                                     }
-                                },
+                                }),
                                 PowerUpDuration,
                                 false);
                             break;
@@ -249,13 +280,13 @@ float AEnemy::TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AC
                             Player->bIsInvulnerable = true;
                             GetWorld()->GetTimerManager().SetTimer(
                                 PowerUpTimerHandle,
-                                [Player]()
+                                FTimerDelegate::CreateWeakLambda(Player, [Player]()
                                 {
                                     if (IsValid(Player))
                                     {
                                         Player->bIsInvulnerable = false;
                                     }
-                                },
+                                }),
                                 PowerUpDuration,
                                 false);
                             break;
@@ -264,13 +295,13 @@ float AEnemy::TakeDamage(float DamageAmount, const FDamageEvent& DamageEvent, AC
                             Player->ScoreMultiplier = 2.0f;
                             GetWorld()->GetTimerManager().SetTimer(
                                 PowerUpTimerHandle,
-                                [Player]()
+                                FTimerDelegate::CreateWeakLambda(Player, [Player]()
                                 {
                                     if (IsValid(Player))
                                     {
                                         Player->ScoreMultiplier = 1.0f;
                                     }
-                                },
+                                }),
                                 PowerUpDuration,
                                 false);
                             break;
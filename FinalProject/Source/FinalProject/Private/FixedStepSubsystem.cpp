@@ -0,0 +1,35 @@
+#include "FixedStepSubsystem.h"
+
+void UFixedStepSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    const float StepSeconds = GetStepSeconds();
+    Accumulator += DeltaTime;
+
+    int32 StepsThisFrame = 0;
+    while (Accumulator >= StepSeconds && StepsThisFrame < MaxStepsPerFrame)
+    {
+        Accumulator -= StepSeconds;
+        ++StepCount;
+        ++StepsThisFrame;
+
+        OnFixedStep.Broadcast(StepSeconds);
+    }
+
+    // Drop any time we couldn't catch up on instead of carrying the debt into the next frame
+    if (StepsThisFrame == MaxStepsPerFrame)
+    {
+        Accumulator = FMath::Min(Accumulator, static_cast<double>(StepSeconds));
+    }
+}
+
+TStatId UFixedStepSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UFixedStepSubsystem, STATGROUP_Tickables);
+}
+
+bool UFixedStepSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Kismet/GameplayStatics.h"
 #include "TopDownGameMode.h"
 #include "TutorialManager.h"
+#include "FixedStepSubsystem.h"
 
 AGameHUD::AGameHUD()
 {
@@ -32,6 +33,30 @@ void AGameHUD::BeginPlay()
         CurrentScore = GameMode->GetCurrentScore();
         GameMode->OnScoreUpdated.AddDynamic(this, &AGameHUD::OnScoreUpdated);
     }
+
+    if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+    {
+        FixedStepHandle = FixedStep->OnFixedStep.AddUObject(this, &AGameHUD::FixedTick);
+    }
+}
+
+void AGameHUD::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+    {
+        FixedStep->OnFixedStep.Remove(FixedStepHandle);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+float AGameHUD::GetInterpolatedTime() const
+{
+    if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+    {
+        return FixedStep->GetInterpolationAlpha() * FixedStep->GetStepSeconds();
+    }
+    return 0.0f;
 }
 
 void AGameHUD::OnScoreUpdated(int32 NewScore)
@@ -119,14 +144,12 @@ void AGameHUD::DrawWaveInfo()
     }
 }
 
-void AGameHUD::Tick(float DeltaTime)
+void AGameHUD::FixedTick(float StepSeconds)
 {
-    Super::Tick(DeltaTime);
-
     // Update power-up durations
     for (int32 i = ActivePowerUps.Num() - 1; i >= 0; --i)
     {
-        ActivePowerUps[i].RemainingDuration -= DeltaTime;
+        ActivePowerUps[i].RemainingDuration -= StepSeconds;
         if (ActivePowerUps[i].RemainingDuration <= 0.0f)
         {
             ActivePowerUps.RemoveAt(i);
@@ -159,6 +182,7 @@ void AGameHUD::DrawPowerUpStatus()
     const float LineHeight = 20.0f;
     const float BarWidth = 150.0f;
     const float BarHeight = 10.0f;
+    const float InterpolatedTime = GetInterpolatedTime();
 
     // Draw each active power-up
     for (const auto& PowerUp : ActivePowerUps)
@@ -234,12 +258,13 @@ void AGameHUD::DrawPowerUpStatus()
         const float BarY = PowerUpY + LineHeight;
         DrawRect(FColor(32, 32, 32, 255), PowerUpX, BarY, BarWidth, BarHeight);
 
-        // Calculate and draw progress bar
-        float Progress = PowerUp.RemainingDuration / PowerUp.TotalDuration;
+        // Calculate and draw progress bar, smoothed between simulation steps
+        const float RemainingDuration = FMath::Max(0.0f, PowerUp.RemainingDuration - InterpolatedTime);
+        float Progress = RemainingDuration / PowerUp.TotalDuration;
         DrawRect(PowerUpColor, PowerUpX, BarY, BarWidth * Progress, BarHeight);
 
         // Draw time remaining
-        FString TimeText = FString::Printf(TEXT("%.1fs"), PowerUp.RemainingDuration);
+        FString TimeText = FString::Printf(TEXT("%.1fs"), RemainingDuration);
         DrawText(TimeText, FColor::White, PowerUpX + BarWidth + 10.0f, PowerUpY, HUDFont, 1.0f);
 
         // Move to next line
@@ -287,8 +312,8 @@ void AGameHUD::DrawAmmoCount()
         // Draw background
         DrawRect(FColor(64, 64, 64, 255), AmmoX, BarY, BarWidth, BarHeight);
         
-        // Draw progress
-        const float Progress = PlayerCharacter->GetReloadProgress();
+        // Draw progress, smoothed between simulation steps
+        const float Progress = FMath::Min(1.0f, PlayerCharacter->GetReloadProgress() + GetInterpolatedTime() / PlayerCharacter->ReloadTime);
         DrawRect(FColor::Yellow, AmmoX, BarY, BarWidth * Progress, BarHeight);
         
         // Draw "Reloading..." text
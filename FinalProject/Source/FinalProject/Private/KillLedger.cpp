@@ -0,0 +1,70 @@
+#include "KillLedger.h"
+
+FKillLedger::FKillLedger(int32 Capacity)
+{
+    Ring.SetNum(FMath::Max(1, Capacity));
+}
+
+bool FKillLedger::Record(float Time, float ScoreMultiplier)
+{
+    if (IsFull())
+    {
+        return false;
+    }
+
+    FKillRecord& Kill = Ring[(Head + Count) % Ring.Num()];
+    Kill.Time = Time;
+    Kill.ScoreMultiplier = ScoreMultiplier;
+    ++Count;
+    return true;
+}
+
+int32 FKillLedger::Commit(const FKillScoringRules& Rules, float GlobalMultiplier)
+{
+    int32 TotalPoints = 0;
+
+    for (; Count > 0; --Count, Head = (Head + 1) % Ring.Num())
+    {
+        const FKillRecord& Kill = Ring[Head];
+
+        // Kill within window extends the combo, otherwise it starts a new one
+        if (Kill.Time - LastKillTime <= Rules.MultiKillTimeWindow)
+        {
+            KillsInWindow++;
+        }
+        else
+        {
+            KillsInWindow = 1;
+        }
+        LastKillTime = Kill.Time;
+
+        const int32 Points = ScoreKill(Rules, Kill.ScoreMultiplier, KillsInWindow);
+        TotalPoints += FMath::RoundToInt(Points * GlobalMultiplier);
+    }
+
+    Head = 0;
+    return TotalPoints;
+}
+
+void FKillLedger::Reset()
+{
+    Head = 0;
+    Count = 0;
+    LastKillTime = 0.0f;
+    KillsInWindow = 0;
+}
+
+int32 FKillLedger::ScoreKill(const FKillScoringRules& Rules, float ScoreMultiplier, int32 KillsInWindow)
+{
+    // Calculate base points with player's score multiplier
+    int32 Points = FMath::RoundToInt(Rules.StandardKillScore * ScoreMultiplier);
+
+    // Add multi-kill bonus if applicable
+    if (KillsInWindow > 1)
+    {
+        float Bonus = 1.0f + (Rules.MultiKillBonusPercentage * (KillsInWindow - 1));
+        Points = FMath::RoundToInt(Points * Bonus);
+    }
+
+    return Points;
+}
\ No newline at end of file
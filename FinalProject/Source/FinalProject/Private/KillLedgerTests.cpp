@@ -0,0 +1,208 @@
+#include "KillLedger.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+    // The game mode's scoring from before the ledger: UpdateMultiKill, then AddKillScore, then AddScore
+    // applying the global multiplier, all once per kill
+    struct FPerKillScorer
+    {
+        FKillScoringRules Rules;
+        float GlobalMultiplier = 1.0f;
+
+        int32 CurrentScore = 0;
+        float LastKillTime = 0.0f;
+        int32 KillsInWindow = 0;
+
+        void UpdateMultiKill(float CurrentTime)
+        {
+            if (CurrentTime - LastKillTime <= Rules.MultiKillTimeWindow)
+            {
+                KillsInWindow++;
+            }
+            else
+            {
+                KillsInWindow = 1;
+            }
+
+            LastKillTime = CurrentTime;
+        }
+
+        void AddScore(int32 Points)
+        {
+            CurrentScore += FMath::RoundToInt(Points * GlobalMultiplier);
+        }
+
+        void AddKillScore(float CurrentTime, float PlayerScoreMultiplier)
+        {
+            UpdateMultiKill(CurrentTime);
+
+            int32 Points = FMath::RoundToInt(Rules.StandardKillScore * PlayerScoreMultiplier);
+            if (KillsInWindow > 1)
+            {
+                float Bonus = 1.0f + (Rules.MultiKillBonusPercentage * (KillsInWindow - 1));
+                Points = FMath::RoundToInt(Points * Bonus);
+            }
+
+            AddScore(Points);
+        }
+    };
+
+    struct FTestKill
+    {
+        float Time;
+        float ScoreMultiplier;
+    };
+
+    // Scores the kills through one ledger commit and through the old per-kill path; returns the ledger total
+    int32 ScoreBoth(FAutomationTestBase& Test, const FKillScoringRules& Rules, float GlobalMultiplier, const TArray<FTestKill>& Kills)
+    {
+        FPerKillScorer Reference;
+        Reference.Rules = Rules;
+        Reference.GlobalMultiplier = GlobalMultiplier;
+
+        FKillLedger Ledger(Kills.Num());
+        for (const FTestKill& Kill : Kills)
+        {
+            Test.TestTrue(TEXT("Record fits"), Ledger.Record(Kill.Time, Kill.ScoreMultiplier));
+            Reference.AddKillScore(Kill.Time, Kill.ScoreMultiplier);
+        }
+
+        const int32 Total = Ledger.Commit(Rules, GlobalMultiplier);
+        Test.TestEqual(TEXT("Commit matches per-kill scoring"), Total, Reference.CurrentScore);
+        Test.TestEqual(TEXT("Combo length matches"), Ledger.GetKillsInWindow(), Reference.KillsInWindow);
+        return Total;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FKillLedgerMultiKillTest, "FinalProject.KillLedger.MultiKillWindow", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FKillLedgerMultiKillTest::RunTest(const FString& Parameters)
+{
+    const FKillScoringRules Rules;
+
+    // 100, then +50% and +100% for the second and third kill of the combo
+    TestEqual(TEXT("Three kill combo"), ScoreBoth(*this, Rules, 1.0f, { { 10.0f, 1.0f }, { 10.5f, 1.0f }, { 11.0f, 1.0f } }), 450);
+
+    // A kill exactly on the window edge still extends the combo
+    TestEqual(TEXT("Kill on the window edge"), ScoreBoth(*this, Rules, 1.0f, { { 10.0f, 1.0f }, { 12.0f, 1.0f } }), 250);
+
+    // Every kill inside the window of the previous one, even though the first and last are further apart
+    TestEqual(TEXT("Chained combo"), ScoreBoth(*this, Rules, 1.0f, { { 10.0f, 1.0f }, { 11.5f, 1.0f }, { 13.0f, 1.0f }, { 14.5f, 1.0f } }), 100 + 150 + 200 + 250);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FKillLedgerWindowExpiryTest, "FinalProject.KillLedger.WindowExpiry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FKillLedgerWindowExpiryTest::RunTest(const FString& Parameters)
+{
+    const FKillScoringRules Rules;
+
+    TestEqual(TEXT("Kill after the window"), ScoreBoth(*this, Rules, 1.0f, { { 10.0f, 1.0f }, { 12.5f, 1.0f } }), 200);
+
+    // The combo restarts at one, then builds again
+    TestEqual(TEXT("Combo restarts"), ScoreBoth(*this, Rules, 1.0f, { { 10.0f, 1.0f }, { 10.5f, 1.0f }, { 20.0f, 1.0f }, { 20.5f, 1.0f } }), 100 + 150 + 100 + 150);
+
+    // Combo state carries over between commits, and a quiet spell between them expires it
+    FKillLedger Ledger;
+    Ledger.Record(10.0f, 1.0f);
+    TestEqual(TEXT("First commit"), Ledger.Commit(Rules, 1.0f), 100);
+    Ledger.Record(11.0f, 1.0f);
+    TestEqual(TEXT("Combo across commits"), Ledger.Commit(Rules, 1.0f), 150);
+    Ledger.Record(30.0f, 1.0f);
+    TestEqual(TEXT("Expired across commits"), Ledger.Commit(Rules, 1.0f), 100);
+
+    // Reset forgets the combo
+    Ledger.Record(30.5f, 1.0f);
+    Ledger.Reset();
+    TestFalse(TEXT("Reset drops pending kills"), Ledger.HasPendingKills());
+    Ledger.Record(31.0f, 1.0f);
+    TestEqual(TEXT("No combo after reset"), Ledger.Commit(Rules, 1.0f), 100);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FKillLedgerMultiplierTest, "FinalProject.KillLedger.Multipliers", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FKillLedgerMultiplierTest::RunTest(const FString& Parameters)
+{
+    const FKillScoringRules Rules;
+
+    // Double Points scales the base before the combo bonus
+    TestEqual(TEXT("Double Points combo"), ScoreBoth(*this, Rules, 1.0f, { { 10.0f, 2.0f }, { 10.5f, 2.0f } }), 200 + 300);
+
+    // The multiplier is taken per kill, so it can run out partway through a combo
+    TestEqual(TEXT("Double Points expires mid-combo"), ScoreBoth(*this, Rules, 1.0f, { { 10.0f, 2.0f }, { 10.5f, 1.0f } }), 200 + 150);
+
+    TestEqual(TEXT("Global multiplier"), ScoreBoth(*this, Rules, 1.5f, { { 10.0f, 1.0f }, { 10.5f, 1.0f } }), 150 + 225);
+
+    // Each kill is rounded on its own: 33, 49.5 -> 50, 66, and with x1.5 50, 75, 99
+    FKillScoringRules OddRules;
+    OddRules.StandardKillScore = 33;
+    TestEqual(TEXT("Combo bonus rounding"), ScoreBoth(*this, OddRules, 1.0f, { { 10.0f, 1.0f }, { 10.5f, 1.0f }, { 11.0f, 1.0f } }), 33 + 50 + 66);
+    TestEqual(TEXT("Global multiplier rounding"), ScoreBoth(*this, OddRules, 1.5f, { { 10.0f, 1.0f }, { 10.5f, 1.0f }, { 11.0f, 1.0f } }), 50 + 75 + 99);
+
+    // Every stage rounds: round(33 x 1.5) = 50, round(50 x 1.5) = 75, then x1.1 -> 55 + 83
+    TestEqual(TEXT("Stacked multiplier rounding"), ScoreBoth(*this, OddRules, 1.1f, { { 10.0f, 1.5f }, { 10.5f, 1.5f } }), 55 + 83);
+
+    TestEqual(TEXT("ScoreKill matches the first kill"), FKillLedger::ScoreKill(OddRules, 1.5f, 1), 50);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FKillLedgerRandomTest, "FinalProject.KillLedger.MatchesPerKillScoring", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FKillLedgerRandomTest::RunTest(const FString& Parameters)
+{
+    // Long random sessions committed in random-sized batches, wrapping the ring many times
+    FRandomStream Random(1234);
+
+    for (int32 Session = 0; Session < 20; ++Session)
+    {
+        FKillScoringRules Rules;
+        Rules.StandardKillScore = Random.RandRange(1, 250);
+        Rules.MultiKillBonusPercentage = Random.FRandRange(0.0f, 1.0f);
+        Rules.MultiKillTimeWindow = Random.FRandRange(0.5f, 3.0f);
+        const float GlobalMultiplier = Random.FRandRange(0.5f, 3.0f);
+
+        FPerKillScorer Reference;
+        Reference.Rules = Rules;
+        Reference.GlobalMultiplier = GlobalMultiplier;
+
+        FKillLedger Ledger(8);
+        int32 LedgerScore = 0;
+        float Time = 0.0f;
+
+        for (int32 Kill = 0; Kill < 500; ++Kill)
+        {
+            Time += Random.FRandRange(0.0f, 4.0f);
+            const float ScoreMultiplier = Random.RandRange(0, 3) == 0 ? 2.0f : 1.0f;
+
+            if (!Ledger.Record(Time, ScoreMultiplier))
+            {
+                TestTrue(TEXT("Record only fails when full"), Ledger.IsFull());
+                LedgerScore += Ledger.Commit(Rules, GlobalMultiplier);
+                TestTrue(TEXT("Record after commit"), Ledger.Record(Time, ScoreMultiplier));
+            }
+            Reference.AddKillScore(Time, ScoreMultiplier);
+
+            if (Random.RandRange(0, 4) == 0)
+            {
+                LedgerScore += Ledger.Commit(Rules, GlobalMultiplier);
+            }
+        }
+        LedgerScore += Ledger.Commit(Rules, GlobalMultiplier);
+
+        if (!TestEqual(FString::Printf(TEXT("Session %d score"), Session), LedgerScore, Reference.CurrentScore))
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include "RandomStreamSubsystem.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Crc.h"
+
+const FName URandomStreamSubsystem::SpawnClassChannel(TEXT("SpawnClass"));
+const FName URandomStreamSubsystem::SpawnLocationChannel(TEXT("SpawnLocation"));
+const FName URandomStreamSubsystem::DropChannel(TEXT("Drop"));
+
+void URandomStreamSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    // Command line wins over config so benchmark scripts can pin the seed without editing ini files
+    FParse::Value(FCommandLine::Get(), TEXT("RandomSeed="), Seed);
+
+    BeginRun();
+}
+
+void URandomStreamSubsystem::BeginRun()
+{
+    Reseed(HasFixedSeed() ? Seed : FMath::Rand());
+}
+
+void URandomStreamSubsystem::Reseed(int32 NewSeed)
+{
+    RunSeed = NewSeed;
+
+    // Channels created later are seeded lazily from RunSeed, so existing ones just restart
+    for (TPair<FName, FRandomChannel>& Pair : Channels)
+    {
+        Pair.Value.Stream.Initialize(HashCombine(RunSeed, FCrc::StrCrc32(*Pair.Key.ToString())));
+        Pair.Value.Draws = 0;
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("Gameplay random seed: %d"), RunSeed);
+}
+
+FRandomChannel& URandomStreamSubsystem::GetChannel(FName Channel)
+{
+    if (FRandomChannel* Existing = Channels.Find(Channel))
+    {
+        return *Existing;
+    }
+
+    // Seed from the channel name's CRC rather than the FName hash, which isn't stable between processes
+    FRandomChannel& NewChannel = Channels.Add(Channel);
+    NewChannel.Stream.Initialize(HashCombine(RunSeed, FCrc::StrCrc32(*Channel.ToString())));
+    return NewChannel;
+}
+
+float URandomStreamSubsystem::FRand(FName Channel)
+{
+    FRandomChannel& RandomChannel = GetChannel(Channel);
+    ++RandomChannel.Draws;
+    return RandomChannel.Stream.FRand();
+}
+
+float URandomStreamSubsystem::FRandRange(FName Channel, float Min, float Max)
+{
+    FRandomChannel& RandomChannel = GetChannel(Channel);
+    ++RandomChannel.Draws;
+    return RandomChannel.Stream.FRandRange(Min, Max);
+}
+
+int32 URandomStreamSubsystem::RandRange(FName Channel, int32 Min, int32 Max)
+{
+    FRandomChannel& RandomChannel = GetChannel(Channel);
+    ++RandomChannel.Draws;
+    return RandomChannel.Stream.RandRange(Min, Max);
+}
+
+uint64 URandomStreamSubsystem::GetDrawCount(FName Channel) const
+{
+    const FRandomChannel* RandomChannel = Channels.Find(Channel);
+    return RandomChannel ? RandomChannel->Draws : 0;
+}
+
+void URandomStreamSubsystem::LogChannels() const
+{
+    for (const TPair<FName, FRandomChannel>& Pair : Channels)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Random channel %s: %llu draws (seed %d)"), *Pair.Key.ToString(), Pair.Value.Draws, RunSeed);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,536 @@
+#include "SessionReplaySubsystem.h"
+#include "FixedStepSubsystem.h"
+#include "Survivor.h"
+#include "RandomStreamSubsystem.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    const uint32 ReplayMagic = 0x50525046; // "FPRP"
+    const uint16 ReplayVersion = 4;
+
+    // Record tags; each record is the tag, the packed step delta since the previous record, then the payload
+    enum EReplayTag : uint8
+    {
+        Tag_End = 0,
+        Tag_Input = 1,      // int8 forward, int8 right, uint8 buttons
+        Tag_Aim = 2,        // int16 x, int16 y offset from the survivor in cm
+        Tag_WaveStart = 3,  // packed wave number
+        Tag_RandomDraws = 4, // packed channel count, then name and packed draw count per channel
+        Tag_Position = 5     // int32 x, int32 y survivor location in cm before the step's movement
+    };
+
+    enum EReplayButton : uint8
+    {
+        Button_Fire = 1 << 0,
+        Button_Reload = 1 << 1
+    };
+
+    // Only the first session of a process plays back; a restarted level would otherwise replay it again
+    bool bPlaybackStarted = false;
+
+    int8 QuantizeAxis(float Value)
+    {
+        return static_cast<int8>(FMath::Clamp(FMath::RoundToInt(Value * 127.0f), -127, 127));
+    }
+
+    int16 QuantizeOffset(double Value)
+    {
+        return static_cast<int16>(FMath::Clamp(FMath::RoundToInt(Value), -32767, 32767));
+    }
+
+    FIntPoint QuantizePosition(const FVector& Location)
+    {
+        return FIntPoint(FMath::RoundToInt(Location.X), FMath::RoundToInt(Location.Y));
+    }
+}
+
+void USessionReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+    Collection.InitializeDependency<UFixedStepSubsystem>();
+
+    FString Name;
+    if (FParse::Value(FCommandLine::Get(), TEXT("ReplayPlay="), Name))
+    {
+        ReplayPath = FPaths::IsRelative(Name) ? FPaths::ProjectSavedDir() / TEXT("Replays") / Name : Name;
+        Archive.Reset(IFileManager::Get().CreateFileReader(*ReplayPath));
+        if (!Archive)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Replay file %s could not be opened"), *ReplayPath);
+            return;
+        }
+
+        // The header is read up front so the game mode can pick up the recorded seed in InitGame
+        uint32 Magic = 0;
+        uint16 Version = 0;
+        *Archive << Magic << Version;
+        if (Magic != ReplayMagic || Version != ReplayVersion)
+        {
+            UE_LOG(LogTemp, Error, TEXT("%s is not a version %d replay"), *ReplayPath, ReplayVersion);
+            Archive.Reset();
+            return;
+        }
+
+        *Archive << RecordedStepRate << Seed;
+        Mode = EReplayMode::Playback;
+    }
+    else if (FParse::Value(FCommandLine::Get(), TEXT("ReplayRecord="), RecordName))
+    {
+        ReplayPath = MakeRecordPath();
+        Mode = EReplayMode::Recording;
+    }
+}
+
+void USessionReplaySubsystem::Deinitialize()
+{
+    if (bSessionActive)
+    {
+        EndSession();
+    }
+    Archive.Reset();
+
+    Super::Deinitialize();
+}
+
+FString USessionReplaySubsystem::MakeRecordPath() const
+{
+    return FPaths::ProjectSavedDir() / TEXT("Replays") / FString::Printf(TEXT("%s_%s.fprp"), *RecordName, *FDateTime::Now().ToString());
+}
+
+bool USessionReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 USessionReplaySubsystem::ResolveSeed(int32 DefaultSeed)
+{
+    if (Mode != EReplayMode::Playback)
+    {
+        Seed = DefaultSeed;
+    }
+    return Seed;
+}
+
+void USessionReplaySubsystem::BeginSession(ASurvivor* InSurvivor)
+{
+    if (Mode == EReplayMode::None || bSessionActive || !InSurvivor)
+    {
+        return;
+    }
+
+    UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>();
+    if (!FixedStep)
+    {
+        return;
+    }
+
+    if (Mode == EReplayMode::Recording)
+    {
+        Archive.Reset(IFileManager::Get().CreateFileWriter(*ReplayPath));
+        if (!Archive)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Replay file %s could not be created"), *ReplayPath);
+            Mode = EReplayMode::None;
+            return;
+        }
+
+        uint32 Magic = ReplayMagic;
+        uint16 Version = ReplayVersion;
+        float StepRate = FixedStep->StepRate;
+        *Archive << Magic << Version << StepRate << Seed;
+
+        // Same lock as playback, so the recorded run sees the deltas playback will feed it
+        LockFixedTimeStep(StepRate);
+
+        LastRecordStep = 0;
+        LastInput = FReplayInputState();
+        LastAimOffset = FIntPoint::ZeroValue;
+
+        // Forces the first step to write the starting position
+        LastPosition = FIntPoint(MAX_int32, MAX_int32);
+
+        UE_LOG(LogTemp, Warning, TEXT("Recording session to %s (seed %d)"), *ReplayPath, Seed);
+    }
+    else
+    {
+        if (bPlaybackStarted)
+        {
+            Mode = EReplayMode::None;
+            return;
+        }
+        bPlaybackStarted = true;
+
+        FixedStep->StepRate = RecordedStepRate;
+        LockFixedTimeStep(RecordedStepRate);
+
+        InSurvivor->BeginReplayControl();
+
+        PendingStep = 0;
+        if (!ReadNextRecord())
+        {
+            UE_LOG(LogTemp, Error, TEXT("Replay %s has no records"), *ReplayPath);
+            Mode = EReplayMode::None;
+            return;
+        }
+
+        bHasExpectedPosition = false;
+        DivergedStep = INDEX_NONE;
+
+        FrameTimings.Reset();
+        LastStepRealTime = FPlatformTime::Seconds();
+
+        UE_LOG(LogTemp, Warning, TEXT("Playing back %s (seed %d, %.0f Hz)"), *ReplayPath, Seed, RecordedStepRate);
+    }
+
+    Survivor = InSurvivor;
+    CurrentStep = 0;
+    bSessionActive = true;
+}
+
+void USessionReplaySubsystem::LockFixedTimeStep(float StepRate)
+{
+    // Run the engine at exactly one simulation step per frame so movement, physics and timers
+    // see identical deltas while recording and on every playback, regardless of how fast the machine is
+    if (!bLockedFixedTimeStep)
+    {
+        bSavedUseFixedTimeStep = FApp::UseFixedTimeStep();
+        SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+        bLockedFixedTimeStep = true;
+    }
+    FApp::SetUseFixedTimeStep(true);
+    FApp::SetFixedDeltaTime(1.0 / StepRate);
+}
+
+void USessionReplaySubsystem::UnlockFixedTimeStep()
+{
+    if (bLockedFixedTimeStep)
+    {
+        FApp::SetUseFixedTimeStep(bSavedUseFixedTimeStep);
+        FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+        bLockedFixedTimeStep = false;
+    }
+}
+
+void USessionReplaySubsystem::TickSession()
+{
+    if (!bSessionActive)
+    {
+        return;
+    }
+
+    // Live input was handled by the controller just before this, and the movement component ticks just after,
+    // so recording samples and playback applies the input at the same point, and both see the same position
+    const uint32 Step = CurrentStep++;
+
+    if (Mode == EReplayMode::Recording)
+    {
+        RecordStep(Step);
+    }
+    else if (Mode == EReplayMode::Playback)
+    {
+        PlaybackStep(Step);
+    }
+}
+
+void USessionReplaySubsystem::WriteRecordHeader(uint8 Tag, uint32 Step)
+{
+    uint32 StepDelta = Step - LastRecordStep;
+    *Archive << Tag;
+    Archive->SerializeIntPacked(StepDelta);
+    LastRecordStep = Step;
+}
+
+void USessionReplaySubsystem::RecordStep(uint32 Step)
+{
+    ASurvivor* Player = Survivor.Get();
+    if (!Player || !Archive)
+    {
+        return;
+    }
+
+    // Where the previous steps left the survivor; the movement component hasn't run this step's input yet
+    const FIntPoint Position = QuantizePosition(Player->GetActorLocation());
+    if (Position != LastPosition)
+    {
+        int32 X = Position.X;
+        int32 Y = Position.Y;
+        WriteRecordHeader(Tag_Position, Step);
+        *Archive << X << Y;
+        LastPosition = Position;
+    }
+
+    FReplayInputState Input;
+    const FVector2D MoveInput = Player->GetMoveInput();
+    Input.Forward = QuantizeAxis(MoveInput.X);
+    Input.Right = QuantizeAxis(MoveInput.Y);
+    Input.Buttons = (Player->IsFireHeld() ? Button_Fire : 0) | (Player->ConsumeReloadPressed() ? Button_Reload : 0);
+
+    // Aim only matters while shooting, and goes first so playback aims before it pulls the trigger
+    if (Input.Buttons & Button_Fire)
+    {
+        const FVector Offset = Player->GetAimLocation() - Player->GetActorLocation();
+        const FIntPoint AimOffset(QuantizeOffset(Offset.X), QuantizeOffset(Offset.Y));
+        if (AimOffset != LastAimOffset)
+        {
+            int16 X = AimOffset.X;
+            int16 Y = AimOffset.Y;
+            WriteRecordHeader(Tag_Aim, Step);
+            *Archive << X << Y;
+            LastAimOffset = AimOffset;
+        }
+    }
+
+    if (Input != LastInput)
+    {
+        WriteRecordHeader(Tag_Input, Step);
+        *Archive << Input.Forward << Input.Right << Input.Buttons;
+        LastInput = Input;
+    }
+}
+
+void USessionReplaySubsystem::RecordWaveStart(int32 Wave)
+{
+    if (!bSessionActive)
+    {
+        return;
+    }
+
+    if (Mode == EReplayMode::Recording && Archive)
+    {
+        // Waves start after the survivor's tick, so playback checks them at the start of the next step
+        uint32 PackedWave = Wave;
+        WriteRecordHeader(Tag_WaveStart, CurrentStep);
+        Archive->SerializeIntPacked(PackedWave);
+    }
+    else if (Mode == EReplayMode::Playback)
+    {
+        LastObservedWave = Wave;
+    }
+}
+
+void USessionReplaySubsystem::RestartRecording()
+{
+    // Playback disables player input, so only a recording can be restarted
+    if (Mode != EReplayMode::Recording || !bSessionActive)
+    {
+        return;
+    }
+
+    // Ends with this run's random draw counts, so it has to happen before the streams are reseeded
+    EndSession();
+    ReplayPath = MakeRecordPath();
+}
+
+bool USessionReplaySubsystem::ReadNextRecord()
+{
+    if (!Archive || Archive->AtEnd())
+    {
+        return false;
+    }
+
+    uint32 StepDelta = 0;
+    *Archive << PendingTag;
+    Archive->SerializeIntPacked(StepDelta);
+    PendingStep += StepDelta;
+
+    return !Archive->IsError();
+}
+
+void USessionReplaySubsystem::PlaybackStep(uint32 Step)
+{
+    const double Now = FPlatformTime::Seconds();
+    FrameTimings.Add({ Step, static_cast<float>((Now - LastStepRealTime) * 1000.0), GetWorld()->GetActorCount() });
+    LastStepRealTime = Now;
+
+    ASurvivor* Player = Survivor.Get();
+
+    while (PendingStep <= Step)
+    {
+        switch (PendingTag)
+        {
+            case Tag_Input:
+            {
+                FReplayInputState Input;
+                *Archive << Input.Forward << Input.Right << Input.Buttons;
+                if (Player)
+                {
+                    Player->ApplyReplayInput(FVector2D(Input.Forward / 127.0f, Input.Right / 127.0f),
+                        (Input.Buttons & Button_Fire) != 0, (Input.Buttons & Button_Reload) != 0);
+                }
+                break;
+            }
+
+            case Tag_Aim:
+            {
+                int16 X = 0;
+                int16 Y = 0;
+                *Archive << X << Y;
+                if (Player)
+                {
+                    Player->SetReplayAimOffset(FVector(X, Y, 0.0f));
+                }
+                break;
+            }
+
+            case Tag_WaveStart:
+            {
+                uint32 Wave = 0;
+                Archive->SerializeIntPacked(Wave);
+                if (static_cast<int32>(Wave) != LastObservedWave)
+                {
+                    UE_LOG(LogTemp, Warning, TEXT("Replay diverged at step %u: expected wave %u, simulation is on wave %d"), Step, Wave, LastObservedWave);
+                }
+                break;
+            }
+
+            case Tag_RandomDraws:
+            {
+                URandomStreamSubsystem* Random = UGameInstance::GetSubsystem<URandomStreamSubsystem>(GetWorld()->GetGameInstance());
+                uint32 ChannelCount = 0;
+                Archive->SerializeIntPacked(ChannelCount);
+                for (uint32 Index = 0; Index < ChannelCount; ++Index)
+                {
+                    FString Name;
+                    uint64 Draws = 0;
+                    *Archive << Name;
+                    Archive->SerializeIntPacked64(Draws);
+
+                    const uint64 PlaybackDraws = Random ? Random->GetDrawCount(FName(*Name)) : 0;
+                    if (PlaybackDraws != Draws)
+                    {
+                        UE_LOG(LogTemp, Warning, TEXT("Replay diverged: random channel %s drew %llu values, recording drew %llu"), *Name, PlaybackDraws, Draws);
+                    }
+                }
+                break;
+            }
+
+            case Tag_Position:
+            {
+                int32 X = 0;
+                int32 Y = 0;
+                *Archive << X << Y;
+                ExpectedPosition = FIntPoint(X, Y);
+                bHasExpectedPosition = true;
+                break;
+            }
+
+            default:
+                EndSession();
+                return;
+        }
+
+        if (!ReadNextRecord())
+        {
+            EndSession();
+            return;
+        }
+    }
+
+    CheckPosition(Step);
+}
+
+void USessionReplaySubsystem::CheckPosition(uint32 Step)
+{
+    // Positions are only written when they change, so the last one read holds for every step until the next
+    const ASurvivor* Player = Survivor.Get();
+    if (!Player || !bHasExpectedPosition || DivergedStep != INDEX_NONE)
+    {
+        return;
+    }
+
+    // A centimetre either way covers a value that rounded differently; anything more is a real divergence
+    const FIntPoint Position = QuantizePosition(Player->GetActorLocation());
+    if (FMath::Abs(Position.X - ExpectedPosition.X) > 1 || FMath::Abs(Position.Y - ExpectedPosition.Y) > 1)
+    {
+        DivergedStep = Step;
+        UE_LOG(LogTemp, Error, TEXT("Replay diverged at step %u: survivor is at (%d, %d), recording was at (%d, %d)"),
+            Step, Position.X, Position.Y, ExpectedPosition.X, ExpectedPosition.Y);
+    }
+}
+
+void USessionReplaySubsystem::EndSession()
+{
+    bSessionActive = false;
+
+    UnlockFixedTimeStep();
+
+    URandomStreamSubsystem* Random = UGameInstance::GetSubsystem<URandomStreamSubsystem>(GetWorld()->GetGameInstance());
+
+    if (Mode == EReplayMode::Recording && Archive)
+    {
+        // Store how much each random channel was used so playback can prove it consumed the same sequence;
+        // like wave starts, the counts include draws made after the survivor's tick, so playback checks them on the next step
+        if (Random)
+        {
+            uint32 ChannelCount = Random->GetChannels().Num();
+            WriteRecordHeader(Tag_RandomDraws, CurrentStep);
+            Archive->SerializeIntPacked(ChannelCount);
+            for (const TPair<FName, FRandomChannel>& Pair : Random->GetChannels())
+            {
+                FString Name = Pair.Key.ToString();
+                uint64 Draws = Pair.Value.Draws;
+                *Archive << Name;
+                Archive->SerializeIntPacked64(Draws);
+            }
+        }
+
+        WriteRecordHeader(Tag_End, LastRecordStep);
+        const int64 Size = Archive->Tell();
+        Archive->Close();
+        Archive.Reset();
+
+        UE_LOG(LogTemp, Warning, TEXT("Recorded %u steps to %s (%lld bytes)"), CurrentStep, *ReplayPath, Size);
+    }
+    else if (Mode == EReplayMode::Playback)
+    {
+        Archive.Reset();
+        WriteFrameTimings();
+
+        if (DivergedStep == INDEX_NONE)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Playback matched the recorded position on every step"));
+        }
+
+        // Headless runs report a divergence through the exit code so scripts can fail on it
+        if (FApp::IsUnattended())
+        {
+            FPlatformMisc::RequestExitWithStatus(false, DivergedStep == INDEX_NONE ? 0 : 1);
+        }
+    }
+}
+
+void USessionReplaySubsystem::WriteFrameTimings() const
+{
+    if (FrameTimings.Num() == 0)
+    {
+        return;
+    }
+
+    float TotalMs = 0.0f;
+    float WorstMs = 0.0f;
+    uint32 WorstStep = 0;
+
+    FString Csv = TEXT("Step,FrameMs,Actors\n");
+    for (const FReplayFrameTiming& Timing : FrameTimings)
+    {
+        Csv += FString::Printf(TEXT("%u,%.3f,%d\n"), Timing.Step, Timing.FrameMs, Timing.ActorCount);
+
+        TotalMs += Timing.FrameMs;
+        if (Timing.FrameMs > WorstMs)
+        {
+            WorstMs = Timing.FrameMs;
+            WorstStep = Timing.Step;
+        }
+    }
+
+    const FString CsvPath = FPaths::ProfilingDir() / FPaths::GetBaseFilename(ReplayPath) + TEXT("_frametimes.csv");
+    FFileHelper::SaveStringToFile(Csv, *CsvPath);
+
+    UE_LOG(LogTemp, Warning, TEXT("Playback finished: %d steps, %.2f ms average, worst %.2f ms at step %u. Frame times written to %s"),
+        FrameTimings.Num(), TotalMs / FrameTimings.Num(), WorstMs, WorstStep, *CsvPath);
+}
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include "SurvivorProjectile.h"
 #include "Kismet/GameplayStatics.h"
 #include "Enemy.h"
+#include "TopDownGameMode.h"
+#include "FixedStepSubsystem.h"
+#include "SessionReplaySubsystem.h"
 
 // Sets default values
 ASurvivor::ASurvivor()
@@ -109,6 +112,30 @@ void ASurvivor::BeginPlay()
         PC->bEnableClickEvents = true;
         PC->bEnableMouseOverEvents = true;
     }
+
+    if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+    {
+        FixedStepHandle = FixedStep->OnFixedStep.AddUObject(this, &ASurvivor::FixedTick);
+    }
+
+    // Movement has to consume the input added in Tick on the same frame, or replayed input would land a step late
+    GetCharacterMovement()->PrimaryComponentTick.AddPrerequisite(this, PrimaryActorTick);
+
+    // Start recording or playing back the session if one was requested on the command line
+    if (USessionReplaySubsystem* Replay = GetWorld()->GetSubsystem<USessionReplaySubsystem>())
+    {
+        Replay->BeginSession(this);
+    }
+}
+
+void ASurvivor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+    {
+        FixedStep->OnFixedStep.Remove(FixedStepHandle);
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -116,14 +143,30 @@ void ASurvivor::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+    // Runs after the controller has handled this frame's input and before the movement component
+    if (USessionReplaySubsystem* Replay = GetWorld()->GetSubsystem<USessionReplaySubsystem>())
+    {
+        Replay->TickSession();
+    }
+
+    // Replays bypass the input component, so feed the recorded axes to movement here
+    if (bDrivenByReplay)
+    {
+        AddMovementInput(FVector::ForwardVector, MoveInput.X);
+        AddMovementInput(FVector::RightVector, MoveInput.Y);
+    }
+}
+
+void ASurvivor::FixedTick(float StepSeconds)
+{
     // Update reload progress if reloading
     if (bIsReloading)
     {
-        ReloadProgress = FMath::Min(1.0f, ReloadProgress + (DeltaTime / ReloadTime));
+        ReloadProgress = FMath::Min(1.0f, ReloadProgress + (StepSeconds / ReloadTime));
     }
 
     // Update power-up effects
-    UpdatePowerUpEffects(DeltaTime);
+    UpdatePowerUpEffects(StepSeconds);
 }
 
 void ASurvivor::UpdatePowerUpEffects(float DeltaTime)
@@ -190,9 +233,9 @@ void ASurvivor::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
     // Bind action functions
     PlayerInputComponent->BindAction("Sprint", IE_Pressed, this, &ASurvivor::StartSprint);
     PlayerInputComponent->BindAction("Sprint", IE_Released, this, &ASurvivor::StopSprint);
-    PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &ASurvivor::StartFire);
-    PlayerInputComponent->BindAction("Fire", IE_Released, this, &ASurvivor::StopFire);
-    PlayerInputComponent->BindAction("Reload", IE_Pressed, this, &ASurvivor::Reload);
+    PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &ASurvivor::OnFirePressed);
+    PlayerInputComponent->BindAction("Fire", IE_Released, this, &ASurvivor::OnFireReleased);
+    PlayerInputComponent->BindAction("Reload", IE_Pressed, this, &ASurvivor::OnReloadPressed);
     PlayerInputComponent->BindAction("ThrowGrenade", IE_Pressed, this, &ASurvivor::ThrowGrenade);
     PlayerInputComponent->BindAction("SwitchWeapon", IE_Pressed, this, &ASurvivor::SwitchWeapon);
     PlayerInputComponent->BindAction("RestartGame", IE_Pressed, this, &ASurvivor::RestartGame);
@@ -200,6 +243,8 @@ void ASurvivor::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 
 void ASurvivor::MoveForward(float Value)
 {
+    MoveInput.X = Value;
+
     if ((Controller != nullptr) && (Value != 0.0f))
     {
         // Move in world coordinates instead of relative to rotation
@@ -209,6 +254,8 @@ void ASurvivor::MoveForward(float Value)
 
 void ASurvivor::MoveRight(float Value)
 {
+    MoveInput.Y = Value;
+
     if ((Controller != nullptr) && (Value != 0.0f))
     {
         // Move in world coordinates instead of relative to rotation
@@ -226,6 +273,61 @@ void ASurvivor::StopSprint()
     GetCharacterMovement()->MaxWalkSpeed = WalkSpeed;
 }
 
+void ASurvivor::OnFirePressed()
+{
+    bFireHeld = true;
+    StartFire();
+}
+
+void ASurvivor::OnFireReleased()
+{
+    bFireHeld = false;
+    StopFire();
+}
+
+void ASurvivor::OnReloadPressed()
+{
+    bReloadPressed = true;
+    Reload();
+}
+
+bool ASurvivor::ConsumeReloadPressed()
+{
+    const bool bWasPressed = bReloadPressed;
+    bReloadPressed = false;
+    return bWasPressed;
+}
+
+void ASurvivor::BeginReplayControl()
+{
+    bDrivenByReplay = true;
+    MoveInput = FVector2D::ZeroVector;
+
+    if (APlayerController* PC = Cast<APlayerController>(GetController()))
+    {
+        DisableInput(PC);
+    }
+}
+
+void ASurvivor::ApplyReplayInput(const FVector2D& InMoveInput, bool bInFireHeld, bool bInReloadPressed)
+{
+    MoveInput = InMoveInput;
+
+    if (bInFireHeld && !bFireHeld)
+    {
+        OnFirePressed();
+    }
+    else if (!bInFireHeld && bFireHeld)
+    {
+        OnFireReleased();
+    }
+
+    if (bInReloadPressed)
+    {
+        OnReloadPressed();
+    }
+}
+
 // Combat function stubs - to be implemented
 void ASurvivor::StartFire()
 {
@@ -318,8 +420,8 @@ void ASurvivor::Fire()
         return;
     }
 
-    // Get mouse cursor position in world space
-    FVector MouseLocation = GetMouseWorldLocation();
+    // Get aim position in world space
+    FVector MouseLocation = GetAimLocation();
     
     // Calculate direction to mouse cursor
     FVector Direction = (MouseLocation - GetActorLocation()).GetSafeNormal();
@@ -403,6 +505,16 @@ void ASurvivor::Fire()
     }
 }
 
+FVector ASurvivor::GetAimLocation() const
+{
+    if (ReplayAimOffset.IsSet())
+    {
+        return GetActorLocation() + ReplayAimOffset.GetValue();
+    }
+
+    return GetMouseWorldLocation();
+}
+
 FVector ASurvivor::GetMouseWorldLocation() const
 {
     if (APlayerController* PC = Cast<APlayerController>(GetController()))
@@ -439,13 +551,13 @@ void ASurvivor::Reload()
         ReloadProgress = 0.0f;
         
         // Set timer to re-enable firing and restore ammo
-        GetWorldTimerManager().SetTimer(ReloadTimerHandle, [this]()
+        GetWorldTimerManager().SetTimer(ReloadTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
         {
             CurrentAmmo = MaxAmmo;
             bCanFire = true;
             bIsReloading = false;
             ReloadProgress = 0.0f;
-        }, ReloadTime, false);
+        }), ReloadTime, false);
     }
 }
 
@@ -539,11 +651,11 @@ void ASurvivor::ActivateShield(float Duration, float ShieldAmount)
 
     // Set timer to deactivate shield
     FTimerHandle ShieldTimerHandle;
-    GetWorldTimerManager().SetTimer(ShieldTimerHandle, [this]()
+    GetWorldTimerManager().SetTimer(ShieldTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
     {
         bHasShield = false;
         ShieldHealth = 0.0f;
-    }, Duration, false);
+    }), Duration, false);
 }
 
 void ASurvivor::ActivateHealthRegen(float Duration, float RegenRate)
@@ -553,11 +665,11 @@ void ASurvivor::ActivateHealthRegen(float Duration, float RegenRate)
 
     // Set timer to deactivate health regen
     FTimerHandle RegenTimerHandle;
-    GetWorldTimerManager().SetTimer(RegenTimerHandle, [this]()
+    GetWorldTimerManager().SetTimer(RegenTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
     {
         bHasHealthRegen = false;
         HealthRegenRate = 0.0f;
-    }, Duration, false);
+    }), Duration, false);
 }
 
 void ASurvivor::ActivateInfiniteAmmo(float Duration)
@@ -566,10 +678,10 @@ void ASurvivor::ActivateInfiniteAmmo(float Duration)
 
     // Set timer to deactivate infinite ammo
     FTimerHandle AmmoTimerHandle;
-    GetWorldTimerManager().SetTimer(AmmoTimerHandle, [this]()
+    GetWorldTimerManager().SetTimer(AmmoTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
     {
         bHasInfiniteAmmo = false;
-    }, Duration, false);
+    }), Duration, false);
 }
 
 void ASurvivor::ActivateExplosiveRounds(float Duration, float Radius, float Damage)
@@ -580,10 +692,10 @@ void ASurvivor::ActivateExplosiveRounds(float Duration, float Radius, float Dama
 
     // Set timer to deactivate explosive rounds
     FTimerHandle ExplosiveTimerHandle;
-    GetWorldTimerManager().SetTimer(ExplosiveTimerHandle, [this]()
+    GetWorldTimerManager().SetTimer(ExplosiveTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
     {
         bHasExplosiveRounds = false;
-    }, Duration, false);
+    }), Duration, false);
 }
 
 void ASurvivor::ActivateVampire(float Duration)
@@ -592,10 +704,10 @@ void ASurvivor::ActivateVampire(float Duration)
 
     // Set timer to deactivate vampire effect
     FTimerHandle VampireTimerHandle;
-    GetWorldTimerManager().SetTimer(VampireTimerHandle, [this]()
+    GetWorldTimerManager().SetTimer(VampireTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
     {
         bHasVampire = false;
-    }, Duration, false);
+    }), Duration, false);
 }
 
 void ASurvivor::ActivateMultiShot(float Duration)
@@ -604,10 +716,10 @@ void ASurvivor::ActivateMultiShot(float Duration)
 
     // Set timer to deactivate multi-shot
     FTimerHandle MultiShotTimerHandle;
-    GetWorldTimerManager().SetTimer(MultiShotTimerHandle, [this]()
+    GetWorldTimerManager().SetTimer(MultiShotTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
     {
         bHasMultiShot = false;
-    }, Duration, false);
+    }), Duration, false);
 }
 
 void ASurvivor::ActivatePiercingRounds(float Duration)
@@ -616,10 +728,10 @@ void ASurvivor::ActivatePiercingRounds(float Duration)
 
     // Set timer to deactivate piercing rounds
     FTimerHandle PiercingTimerHandle;
-    GetWorldTimerManager().SetTimer(PiercingTimerHandle, [this]()
+    GetWorldTimerManager().SetTimer(PiercingTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
     {
         bHasPiercingRounds = false;
-    }, Duration, false);
+    }), Duration, false);
 }
 
 void ASurvivor::ActivateFreezeAura(float Duration)
@@ -628,10 +740,10 @@ void ASurvivor::ActivateFreezeAura(float Duration)
 
     // Set timer to deactivate freeze aura
     FTimerHandle FreezeTimerHandle;
-    GetWorldTimerManager().SetTimer(FreezeTimerHandle, [this]()
+    GetWorldTimerManager().SetTimer(FreezeTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
     {
         bHasFreezeAura = false;
-    }, Duration, false);
+    }), Duration, false);
 }
 
 void ASurvivor::ActivateChainLightning(float Duration)
@@ -640,10 +752,10 @@ void ASurvivor::ActivateChainLightning(float Duration)
 
     // Set timer to deactivate chain lightning
     FTimerHandle ChainLightningTimerHandle;
-    GetWorldTimerManager().SetTimer(ChainLightningTimerHandle, [this]()
+    GetWorldTimerManager().SetTimer(ChainLightningTimerHandle, FTimerDelegate::CreateWeakLambda(this, [this]()
     {
         bHasChainLightning = false;
-    }, Duration, false);
+    }), Duration, false);
 }
 
 void ASurvivor::RestartGame()
@@ -655,7 +767,16 @@ void ASurvivor::RestartGame()
     if (CurrentHealth <= 0)
     {
         UE_LOG(LogTemp, Warning, TEXT("Health check passed, restarting level"));
-        UGameplayStatics::OpenLevel(GetWorld(), FName(*GetWorld()->GetName()), false);
+
+        // Reset the arena in place; only fall back to reloading the map outside the top-down game mode
+        if (ATopDownGameMode* GameMode = Cast<ATopDownGameMode>(UGameplayStatics::GetGameMode(GetWorld())))
+        {
+            GameMode->SoftRestart();
+        }
+        else
+        {
+            UGameplayStatics::OpenLevel(GetWorld(), FName(*GetWorld()->GetName()), false);
+        }
     }
     else
     {
@@ -663,3 +784,48 @@ void ASurvivor::RestartGame()
     }
 }
 
+void ASurvivor::ResetSurvivor(const FVector& Location, const FRotator& Rotation)
+{
+    // Stops firing, reloading and every power-up countdown, including the ones enemy drops started
+    GetWorldTimerManager().ClearAllTimersForObject(this);
+
+    CurrentHealth = MaxHealth;
+    CurrentAmmo = MaxAmmo;
+    bCanFire = true;
+    bIsFiring = false;
+    bIsReloading = false;
+    ReloadProgress = 0.0f;
+    FireRate = OriginalFireRate;
+
+    MoveInput = FVector2D::ZeroVector;
+    bFireHeld = false;
+    bReloadPressed = false;
+
+    // Clear every power-up
+    DamageMultiplier = 1.0f;
+    ScoreMultiplier = 1.0f;
+    bIsInvulnerable = false;
+    bHasShield = false;
+    ShieldHealth = 0.0f;
+    bHasHealthRegen = false;
+    HealthRegenRate = 0.0f;
+    bHasInfiniteAmmo = false;
+    bHasExplosiveRounds = false;
+    bHasVampire = false;
+    bHasMultiShot = false;
+    bHasPiercingRounds = false;
+    bHasFreezeAura = false;
+    bHasChainLightning = false;
+
+    GetCharacterMovement()->MaxWalkSpeed = WalkSpeed;
+    GetCharacterMovement()->StopMovementImmediately();
+    SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+
+    // Death removed the movement and combat bindings, so bind everything again from scratch
+    if (InputComponent)
+    {
+        InputComponent->ClearActionBindings();
+        InputComponent->AxisBindings.Reset();
+        SetupPlayerInputComponent(InputComponent);
+    }
+}
\ No newline at end of file
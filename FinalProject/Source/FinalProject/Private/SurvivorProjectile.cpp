@@ -8,6 +8,7 @@
 #include "Kismet/GameplayStatics.h"
 #include "DrawDebugHelpers.h"
 #include "Survivor.h"
+#include "FixedStepSubsystem.h"
 
 ASurvivorProjectile::ASurvivorProjectile()
 {
@@ -58,6 +59,14 @@ void ASurvivorProjectile::BeginPlay()
     
     // Bind the OnHit function
     ProjectileMesh->OnComponentHit.AddDynamic(this, &ASurvivorProjectile::OnHit);
+
+    // Integrate flight in simulation-sized steps so hits don't depend on the render frame rate
+    if (UFixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UFixedStepSubsystem>())
+    {
+        ProjectileMovement->bForceSubStepping = true;
+        ProjectileMovement->MaxSimulationTimeStep = FixedStep->GetStepSeconds();
+        ProjectileMovement->MaxSimulationIterations = FixedStep->MaxStepsPerFrame;
+    }
 }
 
 void ASurvivorProjectile::OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, 
@@ -3,6 +3,11 @@
 #include "Survivor.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameHUD.h"
+#include "WaveManager.h"
+#include "SurvivorProjectile.h"
+#include "EngineUtils.h"
+#include "SessionReplaySubsystem.h"
+#include "RandomStreamSubsystem.h"
 
 ATopDownGameMode::ATopDownGameMode()
 {
@@ -18,13 +23,48 @@ ATopDownGameMode::ATopDownGameMode()
     // Initialize scoring variables
     CurrentScore = 0;
     ScoreMultiplier = 1.0f;
-    LastKillTime = 0.0f;
-    KillsInWindow = 0;
+
+    // Kills are scored once per frame after everything that can kill has ticked
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.TickGroup = TG_PostUpdateWork;
 
     // Set the default HUD class
     HUDClass = AGameHUD::StaticClass();
 }
 
+void ATopDownGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+    Super::InitGame(MapName, Options, ErrorMessage);
+
+    // Every level load is a new run; a replay then swaps in the seed it was recorded with
+    if (URandomStreamSubsystem* Random = UGameInstance::GetSubsystem<URandomStreamSubsystem>(GetGameInstance()))
+    {
+        Random->BeginRun();
+
+        if (USessionReplaySubsystem* Replay = GetWorld()->GetSubsystem<USessionReplaySubsystem>())
+        {
+            const int32 Seed = Replay->ResolveSeed(Random->GetSeed());
+            if (Seed != Random->GetSeed())
+            {
+                Random->Reseed(Seed);
+            }
+        }
+    }
+}
+
+void ATopDownGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    CommitKills();
+
+    // Draw counts per channel make it easy to confirm two benchmark runs consumed identical sequences
+    if (URandomStreamSubsystem* Random = UGameInstance::GetSubsystem<URandomStreamSubsystem>(GetGameInstance()))
+    {
+        Random->LogChannels();
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void ATopDownGameMode::AddScore(int32 Points)
 {
     // Apply score multiplier
@@ -35,57 +75,69 @@ void ATopDownGameMode::AddScore(int32 Points)
     OnScoreUpdated.Broadcast(CurrentScore);
 }
 
+void ATopDownGameMode::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    CommitKills();
+}
+
 void ATopDownGameMode::AddKillScore()
 {
-    if (ASurvivor* Player = Cast<ASurvivor>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0)))
+    if (!CachedSurvivor.IsValid())
     {
-        // Update multi-kill tracking
-        UpdateMultiKill();
-        
-        // Calculate base points with player's score multiplier
-        int32 Points = FMath::RoundToInt(StandardKillScore * Player->ScoreMultiplier);
-        
-        // Add multi-kill bonus if applicable
-        if (KillsInWindow > 1)
+        CachedSurvivor = Cast<ASurvivor>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
+        if (!CachedSurvivor.IsValid())
         {
-            float Bonus = 1.0f + (MultiKillBonusPercentage * (KillsInWindow - 1));
-            Points = FMath::RoundToInt(Points * Bonus);
+            return;
         }
-        
-        // Add the points using existing method
-        AddScore(Points);
     }
-}
 
-void ATopDownGameMode::SetScoreMultiplier(float NewMultiplier)
-{
-    ScoreMultiplier = NewMultiplier;
+    // Only a full buffer forces an early commit; otherwise the kill waits for this frame's Tick
+    if (KillLedger.IsFull())
+    {
+        CommitKills();
+    }
+
+    KillLedger.Record(UGameplayStatics::GetTimeSeconds(this), CachedSurvivor->ScoreMultiplier);
 }
 
-void ATopDownGameMode::UpdateMultiKill()
+void ATopDownGameMode::CommitKills()
 {
-    float CurrentTime = UGameplayStatics::GetTimeSeconds(this);
-    
-    if (CurrentTime - LastKillTime <= MultiKillTimeWindow)
+    if (!KillLedger.HasPendingKills())
     {
-        // Kill within window, increment combo
-        KillsInWindow++;
+        return;
     }
-    else
-    {
-        // Reset combo
-        KillsInWindow = 1;
-    }
-    
-    LastKillTime = CurrentTime;
+
+    CurrentScore += KillLedger.Commit(GetScoringRules(), ScoreMultiplier);
+
+    // Broadcast score update
+    OnScoreUpdated.Broadcast(CurrentScore);
+}
+
+FKillScoringRules ATopDownGameMode::GetScoringRules() const
+{
+    FKillScoringRules Rules;
+    Rules.StandardKillScore = StandardKillScore;
+    Rules.MultiKillBonusPercentage = MultiKillBonusPercentage;
+    Rules.MultiKillTimeWindow = MultiKillTimeWindow;
+    return Rules;
+}
+
+void ATopDownGameMode::SetScoreMultiplier(float NewMultiplier)
+{
+    // Kills made before the change still score at the old multiplier
+    CommitKills();
+
+    ScoreMultiplier = NewMultiplier;
 }
 
 float ATopDownGameMode::GetMultiKillTimeRemaining() const
 {
     float CurrentTime = UGameplayStatics::GetTimeSeconds(this);
-    float TimeElapsed = CurrentTime - LastKillTime;
+    float TimeElapsed = CurrentTime - KillLedger.GetLastKillTime();
     
-    if (TimeElapsed >= MultiKillTimeWindow || KillsInWindow <= 1)
+    if (TimeElapsed >= MultiKillTimeWindow || KillLedger.GetKillsInWindow() <= 1)
     {
         return 0.0f;
     }
@@ -97,4 +149,74 @@ void ATopDownGameMode::StartGame()
 {
     // Transition to the gameplay level
     UGameplayStatics::OpenLevel(GetWorld(), TEXT("GameplayLevel"));
+}
+
+void ATopDownGameMode::SoftRestart()
+{
+    const double StartTime = FPlatformTime::Seconds();
+    UWorld* World = GetWorld();
+
+    APlayerController* PC = UGameplayStatics::GetPlayerController(World, 0);
+    ASurvivor* Player = PC ? Cast<ASurvivor>(PC->GetPawn()) : nullptr;
+    if (!Player)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SoftRestart: no survivor to restart"));
+        return;
+    }
+
+    // The finished run's recording has to be closed before the random streams are reset
+    USessionReplaySubsystem* Replay = World->GetSubsystem<USessionReplaySubsystem>();
+    if (Replay)
+    {
+        Replay->RestartRecording();
+    }
+
+    // A fresh seed, same as a level load would pick
+    if (URandomStreamSubsystem* Random = UGameInstance::GetSubsystem<URandomStreamSubsystem>(GetGameInstance()))
+    {
+        Random->BeginRun();
+        if (Replay)
+        {
+            Replay->ResolveSeed(Random->GetSeed());
+        }
+    }
+
+    // Projectiles still in flight would hit the next wave
+    for (TActorIterator<ASurvivorProjectile> It(World); It; ++It)
+    {
+        It->Destroy();
+    }
+
+    FVector Location = Player->GetActorLocation();
+    FRotator Rotation = Player->GetActorRotation();
+    if (AActor* PlayerStart = FindPlayerStart(PC))
+    {
+        Location = PlayerStart->GetActorLocation();
+        Rotation = PlayerStart->GetActorRotation();
+    }
+    Player->ResetSurvivor(Location, Rotation);
+
+    // Reset scoring
+    KillLedger.Reset();
+    CurrentScore = 0;
+    ScoreMultiplier = 1.0f;
+    OnScoreUpdated.Broadcast(CurrentScore);
+
+    if (AGameHUD* GameHUD = Cast<AGameHUD>(PC->GetHUD()))
+    {
+        GameHUD->ClearActivePowerUps();
+    }
+
+    if (Replay)
+    {
+        Replay->BeginSession(Player);
+    }
+
+    // Waves go last so the first one spawns around the survivor's new position and lands in the new recording
+    if (AWaveManager* WaveManager = Cast<AWaveManager>(UGameplayStatics::GetActorOfClass(World, AWaveManager::StaticClass())))
+    {
+        WaveManager->ResetWaves();
+    }
+
+    UE_LOG(LogTemp, Warning, TEXT("Soft restart took %.2f ms"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "WaveManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "TimerManager.h"
+#include "EngineUtils.h"
 #include "TutorialHUD.h"
 #include "GameHUD.h"
+#include "SessionReplaySubsystem.h"
+#include "RandomStreamSubsystem.h"
 
 AWaveManager::AWaveManager()
 {
@@ -13,6 +16,14 @@ void AWaveManager::BeginPlay()
 {
     Super::BeginPlay();
     UE_LOG(LogTemp, Warning, TEXT("WaveManager BeginPlay"));
+
+    // Recorded and replayed sessions skip the tutorial so waves start at the same step every run
+    USessionReplaySubsystem* Replay = GetWorld()->GetSubsystem<USessionReplaySubsystem>();
+    if (Replay && Replay->GetMode() != EReplayMode::None)
+    {
+        StartWave();
+        return;
+    }
     
     // Spawn tutorial manager
     FActorSpawnParameters SpawnParams;
@@ -99,6 +110,11 @@ void AWaveManager::StartWave()
     TotalEnemiesInWave = EnemiesToSpawn;  // Store total enemies for the wave
     
     UE_LOG(LogTemp, Warning, TEXT("Starting Wave %d with %d enemies"), CurrentWave, EnemiesToSpawn);
+
+    if (USessionReplaySubsystem* Replay = GetWorld()->GetSubsystem<USessionReplaySubsystem>())
+    {
+        Replay->RecordWaveStart(CurrentWave);
+    }
     
     // Spawn all enemies at once
     while (EnemiesRemainingInWave > 0)
@@ -109,8 +125,11 @@ void AWaveManager::StartWave()
 
 TSubclassOf<AEnemy> AWaveManager::GetRandomEnemyClass() const
 {
+    URandomStreamSubsystem* Random = UGameInstance::GetSubsystem<URandomStreamSubsystem>(GetGameInstance());
+    check(Random);
+
     float TotalWeight = StandardZombieWeight + FastZombieWeight + TankZombieWeight;
-    float RandomValue = FMath::RandRange(0.0f, TotalWeight);
+    float RandomValue = Random->FRandRange(URandomStreamSubsystem::SpawnClassChannel, 0.0f, TotalWeight);
     
     if (RandomValue < StandardZombieWeight)
     {
@@ -182,7 +201,9 @@ FVector AWaveManager::GetRandomSpawnLocation() const
                 FVector PlayerLocation = PlayerPawn->GetActorLocation();
                 
                 // Get random point in circle around player
-                float Angle = FMath::RandRange(0.0f, 360.0f);
+                URandomStreamSubsystem* Random = UGameInstance::GetSubsystem<URandomStreamSubsystem>(GetGameInstance());
+                check(Random);
+                float Angle = Random->FRandRange(URandomStreamSubsystem::SpawnLocationChannel, 0.0f, 360.0f);
                 float X = SpawnRadius * FMath::Cos(FMath::DegreesToRadians(Angle));
                 float Y = SpawnRadius * FMath::Sin(FMath::DegreesToRadians(Angle));
                 
@@ -225,4 +246,24 @@ void AWaveManager::WaveCompleted()
 void AWaveManager::PrepareNextWave()
 {
     StartWave();
-} 
\ No newline at end of file
+}
+
+void AWaveManager::ResetWaves()
+{
+    GetWorldTimerManager().ClearAllTimersForObject(this);
+
+    // Unbind before destroying so the cleared enemies don't complete the wave
+    for (TActorIterator<AEnemy> It(GetWorld()); It; ++It)
+    {
+        It->OnDestroyed.RemoveDynamic(this, &AWaveManager::OnActorDestroyed);
+        It->Destroy();
+    }
+
+    CurrentWave = 0;
+    EnemiesRemainingInWave = 0;
+    TotalEnemiesInWave = 0;
+    LivingEnemies = 0;
+
+    // The tutorial has already been played, so go straight to the first wave
+    StartWave();
+}
\ No newline at end of file
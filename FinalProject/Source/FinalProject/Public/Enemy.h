@@ -51,6 +51,10 @@ public:
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Steering and melee checks, run at the fixed simulation rate
+    void FixedTick(float StepSeconds);
 
     UPROPERTY(VisibleAnywhere)
     UStaticMeshComponent* VisibleComponent;
@@ -59,4 +63,10 @@ protected:
     UWidgetComponent* HealthBarWidget;
 
     void UpdateHealthBar();
+
+private:
+    // Direction chosen by the last simulation step, fed to movement every frame
+    FVector MoveDirection = FVector::ZeroVector;
+
+    FDelegateHandle FixedStepHandle;
 }; 
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FixedStepSubsystem.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnFixedStepSignature, float /* StepSeconds */);
+
+/**
+ * Runs gameplay simulation in fixed-size steps, independent of the render frame rate.
+ * Frame time is accumulated and consumed StepRate times per second; whatever is left over
+ * is exposed as an interpolation alpha so drawing code can smooth between steps.
+ */
+UCLASS(Config = Game)
+class FINALPROJECT_API UFixedStepSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Simulation steps per second
+    UPROPERTY(Config)
+    float StepRate = 60.0f;
+
+    // Cap on steps per frame so a long hitch can't snowball into ever longer frames
+    UPROPERTY(Config)
+    int32 MaxStepsPerFrame = 5;
+
+    // Fired once per simulation step with the fixed step length
+    FOnFixedStepSignature OnFixedStep;
+
+    float GetStepSeconds() const { return 1.0f / StepRate; }
+
+    // Fraction of a step accumulated since the last one ran (0.0 to 1.0)
+    float GetInterpolationAlpha() const { return FMath::Clamp(static_cast<float>(Accumulator * StepRate), 0.0f, 1.0f); }
+
+    uint32 GetStepCount() const { return StepCount; }
+
+    // Simulated time in seconds, advanced only by whole steps
+    double GetSimTime() const { return StepCount / static_cast<double>(StepRate); }
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    double Accumulator = 0.0;
+    uint32 StepCount = 0;
+};
@@ -45,11 +45,14 @@ public:
     AGameHUD();
 
     virtual void BeginPlay() override;
-    virtual void Tick(float DeltaTime) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void DrawHUD() override;
 
     void AddActivePowerUp(EPowerUpType Type, float Duration);
 
+    // Drop all power-up countdowns after a soft restart
+    void ClearActivePowerUps() { ActivePowerUps.Reset(); }
+
     UFUNCTION()
     void OnScoreUpdated(int32 NewScore);
 
@@ -63,6 +66,12 @@ public:
     bool IsPowerUpActiveWithDuration(EPowerUpType Type, float MinDuration) const;
 
 protected:
+    // Power-up countdowns, run at the fixed simulation rate
+    void FixedTick(float StepSeconds);
+
+    // Time simulated state lags behind the rendered frame, for smoothing countdowns and bars
+    float GetInterpolatedTime() const;
+
     void DrawHealthBar();
     void DrawWaveInfo();
     void DrawPowerUpStatus();
@@ -79,4 +88,6 @@ private:
 
     UPROPERTY()
     int32 CurrentScore;
+
+    FDelegateHandle FixedStepHandle;
 }; 
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Scoring values the game mode exposes to designers
+struct FKillScoringRules
+{
+    int32 StandardKillScore = 100;
+    float MultiKillBonusPercentage = 0.5f;
+    float MultiKillTimeWindow = 2.0f;
+};
+
+// A kill waiting to be scored
+struct FKillRecord
+{
+    float Time = 0.0f;
+
+    // The killer's score multiplier at the moment of the kill (e.g. Double Points)
+    float ScoreMultiplier = 1.0f;
+};
+
+/**
+ * Collects kills in a fixed-size ring buffer as they happen and scores them in one commit,
+ * so an explosion that kills 30 zombies costs one score update instead of 30.
+ * Kills are scored in the order they were recorded with exactly the per-kill multi-kill rules,
+ * so batching never changes the result.
+ */
+class FINALPROJECT_API FKillLedger
+{
+public:
+    explicit FKillLedger(int32 Capacity = 64);
+
+    // Queue a kill for the next commit; returns false if the buffer is full and a commit is needed first
+    bool Record(float Time, float ScoreMultiplier);
+
+    bool HasPendingKills() const { return Count > 0; }
+    bool IsFull() const { return Count == Ring.Num(); }
+
+    // Score every pending kill in order, advancing the combo state. Returns the total points,
+    // each kill already scaled by GlobalMultiplier and rounded as it would be on its own
+    int32 Commit(const FKillScoringRules& Rules, float GlobalMultiplier);
+
+    // Drop pending kills and combo state
+    void Reset();
+
+    int32 GetKillsInWindow() const { return KillsInWindow; }
+    float GetLastKillTime() const { return LastKillTime; }
+
+    // Points for one kill landing as the KillsInWindow-th kill of a combo, before the global multiplier
+    static int32 ScoreKill(const FKillScoringRules& Rules, float ScoreMultiplier, int32 KillsInWindow);
+
+private:
+    TArray<FKillRecord> Ring;
+    int32 Head = 0;
+    int32 Count = 0;
+
+    float LastKillTime = 0.0f;
+    int32 KillsInWindow = 0;
+};
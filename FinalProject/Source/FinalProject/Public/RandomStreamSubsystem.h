@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "RandomStreamSubsystem.generated.h"
+
+// One independent random sequence plus the number of values drawn from it
+struct FRandomChannel
+{
+    FRandomStream Stream;
+    uint64 Draws = 0;
+};
+
+/**
+ * Seeded random numbers for gameplay, split into independent named channels so that drawing
+ * more from one (e.g. an extra drop roll) never shifts another (e.g. where the next zombie spawns).
+ * The seed comes from -RandomSeed=<N>, then Seed in DefaultGame.ini; 0 means a fresh seed per run.
+ * Every channel counts its draws so two runs can be checked for identical consumption.
+ */
+UCLASS(Config = Game)
+class FINALPROJECT_API URandomStreamSubsystem : public UGameInstanceSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static const FName SpawnClassChannel;
+    static const FName SpawnLocationChannel;
+    static const FName DropChannel;
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+    // Fixed seed from config; 0 picks a new one every run
+    UPROPERTY(Config)
+    int32 Seed = 0;
+
+    // Start a new run: reseed with the fixed seed if there is one, otherwise a fresh random seed
+    void BeginRun();
+
+    // Reset every channel to the start of the sequence for NewSeed and clear the draw counters
+    void Reseed(int32 NewSeed);
+
+    int32 GetSeed() const { return RunSeed; }
+    bool HasFixedSeed() const { return Seed != 0; }
+
+    float FRand(FName Channel);
+    float FRandRange(FName Channel, float Min, float Max);
+    int32 RandRange(FName Channel, int32 Min, int32 Max);
+
+    uint64 GetDrawCount(FName Channel) const;
+    const TMap<FName, FRandomChannel>& GetChannels() const { return Channels; }
+
+    void LogChannels() const;
+
+private:
+    FRandomChannel& GetChannel(FName Channel);
+
+    int32 RunSeed = 0;
+    TMap<FName, FRandomChannel> Channels;
+};
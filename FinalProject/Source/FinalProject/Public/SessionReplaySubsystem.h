@@ -0,0 +1,126 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SessionReplaySubsystem.generated.h"
+
+class ASurvivor;
+
+UENUM()
+enum class EReplayMode : uint8
+{
+    None,
+    Recording,
+    Playback
+};
+
+// Survivor input for one simulation step, quantized the way it is stored on disk
+struct FReplayInputState
+{
+    int8 Forward = 0;
+    int8 Right = 0;
+    uint8 Buttons = 0;
+
+    bool operator==(const FReplayInputState& Other) const
+    {
+        return Forward == Other.Forward && Right == Other.Right && Buttons == Other.Buttons;
+    }
+    bool operator!=(const FReplayInputState& Other) const { return !(*this == Other); }
+};
+
+// Wall-clock cost of one simulation step during playback
+struct FReplayFrameTiming
+{
+    uint32 Step;
+    float FrameMs;
+    int32 ActorCount;
+};
+
+/**
+ * Records a survivor session (movement axes, aim, fire/reload, RNG seed, wave starts, position) to a compact
+ * binary stream and plays it back step for step. Both modes lock the engine to one simulation step per frame
+ * and do their work at the same point of it, in the survivor's tick: after live input has been handled and
+ * before the character moves. Playback checks the survivor's position against the recording on every step. Driven from the command line:
+ *   -ReplayRecord=<Name>   record to Saved/Replays/<Name>_<Timestamp>.fprp
+ *   -ReplayPlay=<Path>     re-simulate a recording; add -nullrhi -unattended to run headless and exit at the end
+ * Playback also writes per-step frame times to Saved/Profiling so spikes can be lined up with the session.
+ */
+UCLASS()
+class FINALPROJECT_API USessionReplaySubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // Seed the gameplay RNG should use; playback returns the recorded seed, recording remembers the given one
+    int32 ResolveSeed(int32 DefaultSeed);
+
+    // Called by the survivor once it is possessed; starts whichever mode was requested
+    void BeginSession(ASurvivor* InSurvivor);
+
+    // Called by the survivor at the start of its tick: records this step's input, or applies the recorded one
+    void TickSession();
+
+    void RecordWaveStart(int32 Wave);
+
+    // Close the current recording before a soft restart; the next BeginSession writes a new file
+    void RestartRecording();
+
+    EReplayMode GetMode() const { return Mode; }
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    void RecordStep(uint32 Step);
+    void PlaybackStep(uint32 Step);
+
+    void CheckPosition(uint32 Step);
+
+    void LockFixedTimeStep(float StepRate);
+    void UnlockFixedTimeStep();
+
+    void WriteRecordHeader(uint8 Tag, uint32 Step);
+    bool ReadNextRecord();
+    void EndSession();
+    void WriteFrameTimings() const;
+    FString MakeRecordPath() const;
+
+    EReplayMode Mode = EReplayMode::None;
+    FString RecordName;
+    FString ReplayPath;
+    TUniquePtr<FArchive> Archive;
+
+    TWeakObjectPtr<ASurvivor> Survivor;
+
+    int32 Seed = 0;
+    float RecordedStepRate = 0.0f;
+
+    // Steps the session has run so far; events after the survivor's tick belong to the next step
+    uint32 CurrentStep = 0;
+    bool bSessionActive = false;
+
+    // Engine timestep settings from before the session locked them
+    bool bLockedFixedTimeStep = false;
+    bool bSavedUseFixedTimeStep = false;
+    double SavedFixedDeltaTime = 0.0;
+
+    // Recording: last values written, so only changes hit the stream
+    uint32 LastRecordStep = 0;
+    FReplayInputState LastInput;
+    FIntPoint LastAimOffset = FIntPoint::ZeroValue;
+    FIntPoint LastPosition = FIntPoint::ZeroValue;
+
+    // Playback: the next record waiting for its step to come up
+    uint8 PendingTag = 0;
+    uint32 PendingStep = 0;
+    int32 LastObservedWave = 0;
+    FIntPoint ExpectedPosition = FIntPoint::ZeroValue;
+    bool bHasExpectedPosition = false;
+    int64 DivergedStep = INDEX_NONE;
+
+    TArray<FReplayFrameTiming> FrameTimings;
+    double LastStepRealTime = 0.0;
+};
@@ -173,15 +173,40 @@ public:
     UFUNCTION()
     void RestartGame();
 
+    // Back to full health and ammo with no power-ups, standing at the given spot; used by the soft restart
+    void ResetSurvivor(const FVector& Location, const FRotator& Rotation);
+
+    // Input as last seen by the survivor, sampled by the session recorder (X = forward, Y = right)
+    FVector2D GetMoveInput() const { return MoveInput; }
+    bool IsFireHeld() const { return bFireHeld; }
+    bool ConsumeReloadPressed();
+
+    // Point the survivor is aiming at, either under the mouse or from a replay
+    FVector GetAimLocation() const;
+
+    // Hand control over to a session replay; player input is ignored from here on
+    void BeginReplayControl();
+    void ApplyReplayInput(const FVector2D& InMoveInput, bool bInFireHeld, bool bInReloadPressed);
+    void SetReplayAimOffset(const FVector& InAimOffset) { ReplayAimOffset = InAimOffset; }
+
 protected:
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Reload progress and power-up effects, run at the fixed simulation rate
+    void FixedTick(float StepSeconds);
 
     void MoveForward(float Value);
     void MoveRight(float Value);
     void StartSprint();
     void StopSprint();
 
+    // Button handlers that remember what was pressed before acting on it
+    void OnFirePressed();
+    void OnFireReleased();
+    void OnReloadPressed();
+
     // Store original fire rate
     float OriginalFireRate;
 
@@ -195,4 +220,14 @@ protected:
 
     // Get mouse position in world space
     FVector GetMouseWorldLocation() const;
+
+private:
+    FDelegateHandle FixedStepHandle;
+
+    FVector2D MoveInput = FVector2D::ZeroVector;
+    bool bFireHeld = false;
+    bool bReloadPressed = false;
+
+    bool bDrivenByReplay = false;
+    TOptional<FVector> ReplayAimOffset;
 }; 
\ No newline at end of file
@@ -2,8 +2,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "KillLedger.h"
 #include "TopDownGameMode.generated.h"
 
+class ASurvivor;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnScoreUpdatedSignature, int32, NewScore);
 
 UCLASS()
@@ -14,6 +17,10 @@ class FINALPROJECT_API ATopDownGameMode : public AGameModeBase
 public:
     ATopDownGameMode();
 
+    virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void Tick(float DeltaTime) override;
+
     void AddScore(int32 Points);
     void AddKillScore();
     void SetScoreMultiplier(float NewMultiplier);
@@ -26,7 +33,7 @@ public:
 
     // New functions for multi-kill info
     UFUNCTION(BlueprintCallable, Category = "Scoring")
-    int32 GetKillsInWindow() const { return KillsInWindow; }
+    int32 GetKillsInWindow() const { return KillLedger.GetKillsInWindow(); }
 
     UFUNCTION(BlueprintCallable, Category = "Scoring")
     float GetMultiKillTimeRemaining() const;
@@ -40,8 +47,15 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Game")
     void StartGame();
 
+    // Put the arena back to the start of a run without reloading the level
+    UFUNCTION(BlueprintCallable, Category = "Game")
+    void SoftRestart();
+
 protected:
-    void UpdateMultiKill();
+    // Score all kills recorded since the last commit and broadcast the new score once
+    void CommitKills();
+
+    FKillScoringRules GetScoringRules() const;
 
     UPROPERTY(EditDefaultsOnly, Category = "Scoring")
     int32 StandardKillScore;
@@ -58,9 +72,8 @@ protected:
     UPROPERTY()
     float ScoreMultiplier;
 
-    UPROPERTY()
-    float LastKillTime;
+    // Kills recorded this frame, scored together in CommitKills
+    FKillLedger KillLedger;
 
-    UPROPERTY()
-    int32 KillsInWindow;
+    TWeakObjectPtr<ASurvivor> CachedSurvivor;
 };
\ No newline at end of file
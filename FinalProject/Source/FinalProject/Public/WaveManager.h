@@ -88,6 +88,9 @@ public:
     UFUNCTION()
     void OnTutorialCompleted();
 
+    // Remove every enemy without counting it as a kill and start again from wave 1
+    void ResetWaves();
+
 protected:
     virtual void BeginPlay() override;
 
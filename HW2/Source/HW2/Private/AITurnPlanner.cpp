@@ -0,0 +1,362 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AITurnPlanner.h"
+#include "GameGrid.h"
+#include "UnitBase.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include <atomic>
+
+namespace
+{
+    const int32 WinScore = 1000000;
+    const int32 Infinity = WinScore * 2;
+
+    struct FPlannerMove
+    {
+        // Index into FSearchBoard's unit cells; 0 is the player
+        int32 Unit;
+        int32 From;
+        int32 To;
+    };
+
+    // Mutable board used during search; moves are made and unmade in place
+    class FSearchBoard
+    {
+    public:
+        FSearchBoard(const FBoardState& State, int InMoveRange)
+            : NumRows(State.NumRows), NumCols(State.NumCols), MoveRange(InMoveRange), Generation(0)
+        {
+            const int32 NumCells = NumRows * NumCols;
+            Occupied.Init(0, NumCells);
+            Stamp.Init(0, NumCells);
+            Cost.SetNumUninitialized(NumCells);
+
+            // A range-limited flood touches at most a diamond of cells
+            Queue.Reserve(FMath::Min(NumCells, 2 * MoveRange * (MoveRange + 1) + 1));
+
+            UnitCells.Add(ToIndex(State.Player));
+            for (const FSGridPosition& Unit : State.AIUnits) UnitCells.Add(ToIndex(Unit));
+            for (const int32 Cell : UnitCells) Occupied[Cell] = 1;
+            for (const FSGridPosition& Obstacle : State.Obstacles) Occupied[ToIndex(Obstacle)] = 1;
+        }
+
+        void GenerateMoves(bool bAITurn, TArray<FPlannerMove>& OutMoves)
+        {
+            OutMoves.Reset();
+
+            if (!bAITurn) {
+                AddUnitMoves(0, OutMoves);
+                return;
+            }
+
+            for (int32 Unit = 1; Unit < UnitCells.Num(); Unit++) {
+                AddUnitMoves(Unit, OutMoves);
+            }
+
+            // Moves towards the player first, so cut-offs come early
+            const int32 PlayerCell = UnitCells[0];
+            OutMoves.Sort([this, PlayerCell](const FPlannerMove& A, const FPlannerMove& B) {
+                return Distance(A.To, PlayerCell) < Distance(B.To, PlayerCell);
+            });
+        }
+
+        void MakeMove(const FPlannerMove& Move)
+        {
+            Occupied[Move.From] = 0;
+            Occupied[Move.To] = 1;
+            UnitCells[Move.Unit] = Move.To;
+        }
+
+        void UnmakeMove(const FPlannerMove& Move)
+        {
+            Occupied[Move.To] = 0;
+            Occupied[Move.From] = 1;
+            UnitCells[Move.Unit] = Move.From;
+        }
+
+        // From the AI's point of view: a trapped player is a win, otherwise less room and shorter distances are better
+        int32 Evaluate()
+        {
+            const int32 PlayerCell = UnitCells[0];
+
+            int32 Mobility = 0;
+            Flood(PlayerCell, [&Mobility](int32) { Mobility++; });
+            if (Mobility == 0) return WinScore;
+
+            int32 TotalDistance = 0;
+            for (int32 Unit = 1; Unit < UnitCells.Num(); Unit++) {
+                TotalDistance += Distance(UnitCells[Unit], PlayerCell);
+            }
+
+            return -(Mobility * 10 + TotalDistance);
+        }
+
+        FSGridPosition ToPosition(int32 Index) const { return FSGridPosition(Index % NumCols, Index / NumCols); }
+
+    private:
+        int32 ToIndex(const FSGridPosition& Position) const { return Position.Row * NumCols + Position.Col; }
+
+        int32 Distance(int32 A, int32 B) const
+        {
+            return FMath::Abs(A / NumCols - B / NumCols) + FMath::Abs(A % NumCols - B % NumCols);
+        }
+
+        void AddUnitMoves(int32 Unit, TArray<FPlannerMove>& OutMoves)
+        {
+            const int32 From = UnitCells[Unit];
+            Flood(From, [&OutMoves, Unit, From](int32 To) { OutMoves.Add({ Unit, From, To }); });
+        }
+
+        // Visit every free cell within MoveRange steps of Origin, not counting Origin itself
+        template <typename FunctorType>
+        void Flood(int32 Origin, FunctorType&& Visit)
+        {
+            if (++Generation == 0) {
+                FMemory::Memzero(Stamp.GetData(), Stamp.Num() * sizeof(uint32));
+                Generation = 1;
+            }
+
+            Queue.Reset();
+            Queue.Add(Origin);
+            Stamp[Origin] = Generation;
+            Cost[Origin] = 0;
+
+            for (int32 Head = 0; Head < Queue.Num(); Head++) {
+                const int32 Cell = Queue[Head];
+                if (Cost[Cell] == MoveRange) continue;
+
+                const int Row = Cell / NumCols;
+                const int Col = Cell % NumCols;
+                const int32 Neighbours[4] = {
+                    Row > 0 ? Cell - NumCols : INDEX_NONE,
+                    Row < NumRows - 1 ? Cell + NumCols : INDEX_NONE,
+                    Col > 0 ? Cell - 1 : INDEX_NONE,
+                    Col < NumCols - 1 ? Cell + 1 : INDEX_NONE
+                };
+
+                for (const int32 Next : Neighbours) {
+                    if (Next == INDEX_NONE || Stamp[Next] == Generation || Occupied[Next]) continue;
+
+                    Stamp[Next] = Generation;
+                    Cost[Next] = Cost[Cell] + 1;
+                    Queue.Add(Next);
+                    Visit(Next);
+                }
+            }
+        }
+
+        int NumRows;
+        int NumCols;
+        int MoveRange;
+
+        TArray<uint8> Occupied;
+        TArray<int32> UnitCells;
+
+        // Flood scratch
+        TArray<uint32> Stamp;
+        TArray<int32> Cost;
+        TArray<int32> Queue;
+        uint32 Generation;
+    };
+
+    // Per-worker search state
+    struct FSearchContext
+    {
+        double Deadline = 0;
+        std::atomic<bool>* bOutOfTime = nullptr;
+        int64 Nodes = 0;
+
+        // One move buffer per ply, reused by every node at that ply
+        TArray<TArray<FPlannerMove>> MovesByPly;
+    };
+
+    // Negamax with alpha-beta; returns the value from the side to move's point of view
+    int32 Search(FSearchBoard& Board, FSearchContext& Context, int Depth, int Ply, int32 Alpha, int32 Beta, bool bAITurn)
+    {
+        if ((++Context.Nodes & 1023) == 0 && FPlatformTime::Seconds() > Context.Deadline) {
+            Context.bOutOfTime->store(true, std::memory_order_relaxed);
+        }
+        if (Context.bOutOfTime->load(std::memory_order_relaxed)) return 0;
+
+        if (Depth == 0) {
+            const int32 Value = Board.Evaluate();
+            return bAITurn ? Value : -Value;
+        }
+
+        TArray<FPlannerMove>& Moves = Context.MovesByPly[Ply];
+        Board.GenerateMoves(bAITurn, Moves);
+
+        if (Moves.Num() == 0) {
+            // A trapped player loses, and the sooner the better for the AI; a stuck AI just passes
+            if (!bAITurn) return -(WinScore + Depth);
+            return -Search(Board, Context, Depth - 1, Ply + 1, -Beta, -Alpha, false);
+        }
+
+        int32 Best = -Infinity;
+        for (const FPlannerMove& Move : Moves) {
+            Board.MakeMove(Move);
+            const int32 Value = -Search(Board, Context, Depth - 1, Ply + 1, -Beta, -Alpha, !bAITurn);
+            Board.UnmakeMove(Move);
+
+            Best = FMath::Max(Best, Value);
+            Alpha = FMath::Max(Alpha, Value);
+            if (Alpha >= Beta) break;
+        }
+
+        return Best;
+    }
+}
+
+FBoardState FBoardState::Capture(const AGameGrid& Grid, const TArray<AUnitBase*>& Units, AUnitBase* ThePlayer)
+{
+    check(ThePlayer);
+
+    FBoardState State;
+    State.NumRows = Grid.NumRows;
+    State.NumCols = Grid.NumCols;
+    State.Player = ThePlayer->GridPosition;
+
+    for (AUnitBase* Unit : Units) {
+        if (!IsValid(Unit) || Unit == ThePlayer) continue;
+
+        if (Unit->IsControlledByThePlayer()) {
+            State.Obstacles.Add(Unit->GridPosition);
+        }
+        else {
+            State.AIUnits.Add(Unit->GridPosition);
+        }
+    }
+
+    return State;
+}
+
+FAIPlanResult FAITurnPlanner::Plan(const FBoardState& State, const FAIPlannerSettings& Settings)
+{
+    FAIPlanResult Result;
+    const double StartTime = FPlatformTime::Seconds();
+
+    FSearchBoard RootBoard(State, Settings.MoveRange);
+    TArray<FPlannerMove> RootMoves;
+    RootBoard.GenerateMoves(true, RootMoves);
+    if (RootMoves.Num() == 0) return Result;
+
+    std::atomic<bool> bOutOfTime(false);
+    std::atomic<int64> TotalNodes(0);
+    const double Deadline = StartTime + Settings.TimeBudgetSeconds;
+
+    TArray<int32> Scores;
+    TArray<bool> bExact;
+
+    for (int Depth = 1; Depth <= Settings.MaxDepth; Depth++) {
+        Scores.Init(-Infinity, RootMoves.Num());
+        bExact.Init(false, RootMoves.Num());
+        std::atomic<int32> SharedAlpha(-Infinity);
+
+        // Each root move gets its own board copy; the best score so far narrows every later search
+        ParallelFor(RootMoves.Num(), [&](int32 Index) {
+            if (bOutOfTime.load(std::memory_order_relaxed)) return;
+
+            FSearchBoard Board(RootBoard);
+            FSearchContext Context;
+            Context.Deadline = Deadline;
+            Context.bOutOfTime = &bOutOfTime;
+            Context.MovesByPly.SetNum(Depth);
+
+            const int32 Alpha = SharedAlpha.load();
+            Board.MakeMove(RootMoves[Index]);
+            const int32 Value = -Search(Board, Context, Depth - 1, 0, -Infinity, -Alpha, false);
+            TotalNodes += Context.Nodes;
+
+            if (bOutOfTime.load(std::memory_order_relaxed)) return;
+
+            // Anything at or below the window is only an upper bound
+            Scores[Index] = Value;
+            bExact[Index] = Value > Alpha;
+
+            int32 Current = SharedAlpha.load();
+            while (Value > Current && !SharedAlpha.compare_exchange_weak(Current, Value)) {}
+        });
+
+        int32 BestIndex = INDEX_NONE;
+        for (int32 Index = 0; Index < RootMoves.Num(); Index++) {
+            if (bExact[Index] && (BestIndex == INDEX_NONE || Scores[Index] > Scores[BestIndex])) {
+                BestIndex = Index;
+            }
+        }
+
+        // An interrupted iteration only counts if nothing deeper was finished yet
+        if (BestIndex == INDEX_NONE || (bOutOfTime && Result.bHasMove)) break;
+
+        const FPlannerMove& Best = RootMoves[BestIndex];
+        Result.bHasMove = true;
+        Result.Move = { ECommandType::Move, RootBoard.ToPosition(Best.From), RootBoard.ToPosition(Best.To) };
+        Result.Value = Scores[BestIndex];
+        Result.Depth = Depth;
+
+        if (bOutOfTime || Result.Value >= WinScore) break;
+
+        // Search the best moves of this iteration first in the next one
+        TArray<int32> Order;
+        Order.SetNum(RootMoves.Num());
+        for (int32 Index = 0; Index < Order.Num(); Index++) Order[Index] = Index;
+        Order.StableSort([&Scores](int32 A, int32 B) { return Scores[A] > Scores[B]; });
+
+        TArray<FPlannerMove> Sorted;
+        Sorted.Reserve(RootMoves.Num());
+        for (const int32 Index : Order) Sorted.Add(RootMoves[Index]);
+        RootMoves = MoveTemp(Sorted);
+    }
+
+    // Fall back to the most promising move if even the first iteration ran out of time
+    if (!Result.bHasMove) {
+        const FPlannerMove& First = RootMoves[0];
+        Result.bHasMove = true;
+        Result.Move = { ECommandType::Move, RootBoard.ToPosition(First.From), RootBoard.ToPosition(First.To) };
+    }
+
+    Result.Nodes = TotalNodes;
+    Result.Seconds = FPlatformTime::Seconds() - StartTime;
+    return Result;
+}
+
+// Usage: HW2.BenchmarkAI [Size=16] [AIUnits=4] [Depth=4] [BudgetMs=2000] [Seed=1]
+static void BenchmarkAI(const TArray<FString>& Args) {
+    const int Size = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 16, 4, 256);
+    const int AIUnitCount = FMath::Clamp(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 4, 1, 32);
+
+    FAIPlannerSettings Settings;
+    Settings.MaxDepth = FMath::Max(1, Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 4);
+    Settings.TimeBudgetSeconds = (Args.Num() > 3 ? FCString::Atoi(*Args[3]) : 2000) / 1000.0;
+    FRandomStream Random(Args.Num() > 4 ? FCString::Atoi(*Args[4]) : 1);
+
+    // Random board: the player, the AI units and obstacles on a tenth of the cells, no two on the same cell
+    TSet<int32> Used;
+    auto RandomFreeCell = [&]() {
+        int32 Cell;
+        do {
+            Cell = Random.RandRange(0, Size * Size - 1);
+        } while (Used.Contains(Cell));
+        Used.Add(Cell);
+        return FSGridPosition(Cell % Size, Cell / Size);
+    };
+
+    FBoardState State;
+    State.NumRows = Size;
+    State.NumCols = Size;
+    State.Player = RandomFreeCell();
+    for (int i = 0; i < AIUnitCount; i++) State.AIUnits.Add(RandomFreeCell());
+    for (int i = 0; i < Size * Size / 10; i++) State.Obstacles.Add(RandomFreeCell());
+
+    const FAIPlanResult Result = FAITurnPlanner::Plan(State, Settings);
+
+    UE_LOG(LogTemp, Warning, TEXT("AI plan on %dx%d with %d AI units: depth %d, %lld nodes in %.1f ms (%.0f nodes/s), move [%d,%d] -> [%d,%d] scoring %d"),
+        Size, Size, AIUnitCount, Result.Depth, Result.Nodes, Result.Seconds * 1000.0, Result.Nodes / FMath::Max(Result.Seconds, 1e-9),
+        Result.Move.Source.Row, Result.Move.Source.Col, Result.Move.Destination.Row, Result.Move.Destination.Col, Result.Value);
+}
+
+static FAutoConsoleCommand BenchmarkAICommand(
+    TEXT("HW2.BenchmarkAI"),
+    TEXT("Run the AI turn planner on a random board and report nodes/second. Args: [Size=16] [AIUnits=4] [Depth=4] [BudgetMs=2000] [Seed=1]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkAI));
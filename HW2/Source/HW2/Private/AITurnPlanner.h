@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Command.h"
+
+class AGameGrid;
+class AUnitBase;
+
+// Compact copy of the board for searching: where the units are, nothing else
+struct FBoardState
+{
+    int NumRows = 0;
+    int NumCols = 0;
+
+    // The unit the player controls; the AI tries to hem it in
+    FSGridPosition Player;
+
+    // Units that move on the AI's turn
+    TArray<FSGridPosition, TInlineAllocator<8>> AIUnits;
+
+    // Every other unit, blocking but never moving
+    TArray<FSGridPosition, TInlineAllocator<8>> Obstacles;
+
+    // Must run on the game thread, since it asks each unit who controls it
+    static FBoardState Capture(const AGameGrid& Grid, const TArray<AUnitBase*>& Units, AUnitBase* ThePlayer);
+};
+
+struct FAIPlannerSettings
+{
+    // Steps a unit may walk in one move, same rule as the player's move range
+    int MoveRange = 4;
+
+    // Plies searched at most; iterative deepening stops earlier when the budget runs out
+    int MaxDepth = 4;
+
+    double TimeBudgetSeconds = 0.5;
+};
+
+struct FAIPlanResult
+{
+    bool bHasMove = false;
+    FCommandRecord Move;
+
+    // Score of the chosen move from the AI's point of view
+    int32 Value = 0;
+
+    // Deepest search that finished within the budget
+    int Depth = 0;
+
+    int64 Nodes = 0;
+    double Seconds = 0;
+};
+
+/**
+ * Alpha-beta search for the AI side. The AI moves one of its units per turn and wins by leaving the
+ * player's unit nowhere to go; short of that it prefers positions close to the player with little room
+ * left to move. Root moves are searched in parallel, each worker on its own copy of the board.
+ */
+class FAITurnPlanner
+{
+public:
+    // Blocking; run it from a worker task
+    static FAIPlanResult Plan(const FBoardState& State, const FAIPlannerSettings& Settings);
+};
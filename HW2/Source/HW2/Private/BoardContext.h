@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridTypes.h"
+
+/**
+ * The board a command runs against. AGameGrid is the one in the level; FSimBoard keeps the same rules
+ * in plain arrays, so any number of boards can be stepped side by side on worker threads. Nothing here
+ * reaches for globals, so several grids can live in one world, or in several PIE worlds, at once.
+ */
+class FBoardContext
+{
+public:
+	virtual ~FBoardContext() {}
+
+	virtual bool IsValidPosition(const FSGridPosition& Position) const = 0;
+	virtual bool IsOccupied(const FSGridPosition& Position) const = 0;
+
+	// Move the unit on Source to Destination, which must be free
+	virtual void MoveUnit(const FSGridPosition& Source, const FSGridPosition& Destination) = 0;
+
+	virtual EGridState GetCellState(const FSGridPosition& Position) const = 0;
+	virtual void SetCellState(const FSGridPosition& Position, EGridState NewState) = 0;
+};
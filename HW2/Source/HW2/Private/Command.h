@@ -5,6 +5,19 @@
 #include "CoreMinimal.h"
 #include "GameSlot.h"
 
+enum class ECommandType : uint8
+{
+    Move
+};
+
+// Everything needed to execute or revert a command, small and flat enough to keep thousands in a ring buffer
+struct FCommandRecord
+{
+    ECommandType Type;
+    FSGridPosition Source;
+    FSGridPosition Destination;
+};
+
 /**
  * 
  */
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CommandHistory.h"
+
+FCommandHistory::FCommandHistory(int32 InCapacity)
+{
+    SetCapacity(InCapacity);
+}
+
+void FCommandHistory::SetCapacity(int32 InCapacity)
+{
+    Ring.SetNumUninitialized(FMath::Max(1, InCapacity));
+    Reset();
+}
+
+void FCommandHistory::Push(const FCommandRecord& Record)
+{
+    // A new command invalidates the redo tail
+    Count = Cursor;
+
+    if (Count == Ring.Num())
+    {
+        Head = (Head + 1) % Ring.Num();
+        Count--;
+        Cursor--;
+        BaseSequence++;
+    }
+
+    Ring[(Head + Count) % Ring.Num()] = Record;
+    Count++;
+    Cursor++;
+}
+
+const FCommandRecord* FCommandHistory::Undo()
+{
+    if (!CanUndo()) return nullptr;
+
+    Cursor--;
+    return &Ring[(Head + Cursor) % Ring.Num()];
+}
+
+const FCommandRecord* FCommandHistory::Redo()
+{
+    if (!CanRedo()) return nullptr;
+
+    const FCommandRecord* Record = &Ring[(Head + Cursor) % Ring.Num()];
+    Cursor++;
+    return Record;
+}
+
+void FCommandHistory::RewindTo(int64 Sequence)
+{
+    check(Sequence <= GetSequence());
+
+    if (Sequence >= BaseSequence)
+    {
+        Cursor = static_cast<int32>(Sequence - BaseSequence);
+        return;
+    }
+
+    Head = 0;
+    Count = 0;
+    Cursor = 0;
+    BaseSequence = Sequence;
+}
+
+void FCommandHistory::Reset()
+{
+    Head = 0;
+    Count = 0;
+    Cursor = 0;
+    BaseSequence = 0;
+}
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Command.h"
+
+/**
+ * Fixed-size undo/redo log of command records. Records are stored in place in a ring buffer,
+ * so pushing, undoing and redoing never allocate; once the buffer is full the oldest record
+ * falls off and can no longer be undone.
+ */
+class FCommandHistory
+{
+public:
+    explicit FCommandHistory(int32 InCapacity = 256);
+
+    // Resize the buffer; drops the whole history
+    void SetCapacity(int32 InCapacity);
+
+    // Record a command that has just been executed; anything that could have been redone is dropped
+    void Push(const FCommandRecord& Record);
+
+    // The record to revert next, or nullptr if there's nothing left to undo
+    const FCommandRecord* Undo();
+
+    // The record to execute again next, or nullptr if there's nothing to redo
+    const FCommandRecord* Redo();
+
+    bool CanUndo() const { return Cursor > 0; }
+    bool CanRedo() const { return Cursor < Count; }
+
+    // Number of commands applied since the start of the level, including ones that fell out of the buffer
+    int64 GetSequence() const { return BaseSequence + Cursor; }
+
+    // Sequence of the oldest state still reachable by undo
+    int64 GetOldestSequence() const { return BaseSequence; }
+
+    // Move back to an earlier sequence after the board was restored to it. Within the buffer the
+    // skipped commands stay redoable; further back the history restarts empty at that sequence
+    void RewindTo(int64 Sequence);
+
+    void Reset();
+
+private:
+    TArray<FCommandRecord> Ring;
+
+    // Ring index of the oldest record, records stored, and how many of them are applied
+    int32 Head;
+    int32 Count;
+    int32 Cursor;
+
+    int64 BaseSequence;
+};
@@ -4,18 +4,26 @@
 #include "GameGrid.h"
 #include "GameSlot.h"
 
-AGameGrid* AGameGrid::GameGrid = nullptr;
-
 
 // Sets default values
-AGameGrid::AGameGrid() : NumCols(8), NumRows(8)
+AGameGrid::AGameGrid() : NumCols(8), NumRows(8), bUseFlatStore(false), CellSize(100, 100), CellMaterial(nullptr), bCellRenderStateDirty(false)
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	// Cell states are flushed in Tick, after gameplay has made this frame's changes
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
 	RootComponent = CreateDefaultSubobject<USceneComponent>(("Root"));
 
-	GameGrid = this;
+	// Flat store visuals; clicks are resolved against the grid plane, so the instances need no collision
+	static ConstructorHelpers::FObjectFinder<UStaticMesh>CellPlaneMesh(TEXT("/Engine/BasicShapes/Plane"));
+
+	CellMesh = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("CellMesh"));
+	CellMesh->SetupAttachment(RootComponent);
+	CellMesh->SetStaticMesh(CellPlaneMesh.Object);
+	CellMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CellMesh->NumCustomDataFloats = 1;
 }
 
 // Called when the game starts or when spawned
@@ -25,7 +33,23 @@ void AGameGrid::BeginPlay()
 	
 }
 
-AGameSlot* AGameGrid::GetSlot(FSGridPosition& Position) {
+// Cells are set up here rather than in BeginPlay, which may run after the game manager has started spawning units
+void AGameGrid::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UpdateCellSpacing();
+
+	if (bUseFlatStore) {
+		Cells.Init(FSGridCell(), NumRows * NumCols);
+
+		if (CellMesh->GetInstanceCount() != Cells.Num()) {
+			BuildCellInstances();
+		}
+	}
+}
+
+AGameSlot* AGameGrid::GetSlot(const FSGridPosition& Position) const {
 	int GridIndex = Position.Row * NumCols + Position.Col;
 	if (GridActors.IsValidIndex(GridIndex)) {
 		return Cast<AGameSlot>(GridActors[GridIndex]->GetChildActor());
@@ -34,12 +58,141 @@ AGameSlot* AGameGrid::GetSlot(FSGridPosition& Position) {
 	return nullptr;
 }
 
-AGameSlot* AGameGrid::FindSlot(FSGridPosition& Position) {
-	if (GameGrid) {
-		return GameGrid->GetSlot(Position);
+bool AGameGrid::IsValidPosition(const FSGridPosition& Position) const {
+	return Position.Row < NumRows && Position.Col < NumCols;
+}
+
+AUnitBase* AGameGrid::GetUnitAt(const FSGridPosition& Position) const {
+	if (!bUseFlatStore) {
+		AGameSlot* Slot = GetSlot(Position);
+		return Slot ? Slot->Unit : nullptr;
 	}
 
-	return nullptr;
+	int Index = GetCellIndex(Position);
+	return Cells.IsValidIndex(Index) ? Cells[Index].Unit : nullptr;
+}
+
+void AGameGrid::SetUnitAt(const FSGridPosition& Position, AUnitBase* Unit) {
+	if (!bUseFlatStore) {
+		if (AGameSlot* Slot = GetSlot(Position)) Slot->Unit = Unit;
+		return;
+	}
+
+	int Index = GetCellIndex(Position);
+	if (Cells.IsValidIndex(Index)) Cells[Index].Unit = Unit;
+}
+
+bool AGameGrid::IsOccupied(const FSGridPosition& Position) const {
+	return GetUnitAt(Position) != nullptr;
+}
+
+void AGameGrid::MoveUnit(const FSGridPosition& Source, const FSGridPosition& Destination) {
+	AUnitBase* Unit = GetUnitAt(Source);
+	check(Unit);
+
+	Unit->AssignToCell(this, Destination);
+}
+
+EGridState AGameGrid::GetCellState(const FSGridPosition& Position) const {
+	if (!bUseFlatStore) {
+		AGameSlot* Slot = GetSlot(Position);
+		return Slot ? Slot->GetState() : GS_Default;
+	}
+
+	int Index = GetCellIndex(Position);
+	return Cells.IsValidIndex(Index) ? Cells[Index].State.GetValue() : GS_Default;
+}
+
+void AGameGrid::SetCellState(const FSGridPosition& Position, EGridState NewState) {
+	if (!bUseFlatStore) {
+		AGameSlot* Slot = GetSlot(Position);
+		if (!Slot || Slot->GetState() == NewState) return;
+
+		Slot->SetState(NewState);
+		return;
+	}
+
+	int Index = GetCellIndex(Position);
+	if (!Cells.IsValidIndex(Index) || Cells[Index].State == NewState) return;
+
+	// Only the CPU copy changes here; the render state is sent once per frame in FlushCellStates
+	Cells[Index].State = NewState;
+	CellMesh->SetCustomDataValue(Index, 0, static_cast<float>(NewState), false);
+	bCellRenderStateDirty = true;
+}
+
+void AGameGrid::QueueSlotUpdate(AGameSlot* Slot) {
+	if (Slot->bStateQueued) return;
+
+	Slot->bStateQueued = true;
+	DirtySlots.Add(Slot);
+}
+
+void AGameGrid::FlushCellStates() {
+	for (AGameSlot* Slot : DirtySlots) {
+		if (!IsValid(Slot)) continue;
+
+		Slot->bStateQueued = false;
+		Slot->ApplyState();
+	}
+	DirtySlots.Reset();
+
+	if (bCellRenderStateDirty) {
+		CellMesh->MarkRenderStateDirty();
+		bCellRenderStateDirty = false;
+	}
+}
+
+FVector AGameGrid::GetCellLocation(const FSGridPosition& Position) const {
+	// Row 0 is the far (+X) edge and column 0 the left (-Y) edge, centered on the actor like the slot layout
+	FVector Relative(
+		(NumRows - Position.Row - 1) * CellSpacing.X - (NumRows * 0.5f - 0.5f) * CellSpacing.X,
+		Position.Col * CellSpacing.Y - (NumCols * 0.5f - 0.5f) * CellSpacing.Y, 0
+	);
+
+	return GetActorTransform().TransformPosition(Relative);
+}
+
+bool AGameGrid::GetCellFromRay(const FVector& Origin, const FVector& Direction, FSGridPosition& OutPosition) const {
+	const FTransform& GridTransform = GetActorTransform();
+	FVector LocalOrigin = GridTransform.InverseTransformPosition(Origin);
+	FVector LocalDirection = GridTransform.InverseTransformVector(Direction);
+
+	// Parallel to the grid or pointing away from it
+	if (FMath::IsNearlyZero(LocalDirection.Z)) return false;
+	float T = -LocalOrigin.Z / LocalDirection.Z;
+	if (T < 0) return false;
+
+	FVector Hit = LocalOrigin + LocalDirection * T;
+
+	// Inverse of the layout in GetCellLocation
+	int Row = NumRows - 1 - FMath::RoundToInt((Hit.X + (NumRows * 0.5f - 0.5f) * CellSpacing.X) / CellSpacing.X);
+	int Col = FMath::RoundToInt((Hit.Y + (NumCols * 0.5f - 0.5f) * CellSpacing.Y) / CellSpacing.Y);
+
+	if (Row < 0 || Row >= NumRows || Col < 0 || Col >= NumCols) return false;
+
+	OutPosition = FSGridPosition(Col, Row);
+	return true;
+}
+
+AUnitBase* AGameGrid::SpawnUnitAt(TSubclassOf<AUnitBase> UnitClass, const FSGridPosition& Position) {
+	if (!IsValidPosition(Position) || GetUnitAt(Position)) return nullptr;
+
+	FVector Location = GetCellLocation(Position);
+	AUnitBase* NewUnit = Cast<AUnitBase>(GetWorld()->SpawnActor(UnitClass, &Location));
+	if (NewUnit) NewUnit->AssignToCell(this, Position);
+	return NewUnit;
+}
+
+bool AGameGrid::SetDimensions(int InNumRows, int InNumCols) {
+	if (!bUseFlatStore) return InNumRows == NumRows && InNumCols == NumCols;
+
+	NumRows = InNumRows;
+	NumCols = InNumCols;
+
+	Cells.Init(FSGridCell(), NumRows * NumCols);
+	BuildCellInstances();
+	return true;
 }
 
 // Called every frame
@@ -47,6 +200,38 @@ void AGameGrid::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	FlushCellStates();
+
+}
+
+void AGameGrid::UpdateCellSpacing() {
+	CellSpacing = FVector(CellSize.X, CellSize.Y, 0);
+
+	if (!bUseFlatStore && GridClass->IsValidLowLevel()) {
+		if (AGameSlot* Slot = GridClass->GetDefaultObject<AGameSlot>()) {
+			CellSpacing = Slot->Box->GetScaledBoxExtent() * 2;
+		}
+	}
+}
+
+void AGameGrid::BuildCellInstances() {
+	CellMesh->ClearInstances();
+	CellMesh->SetMaterial(0, CellMaterial);
+
+	// The engine plane is 100x100, scale it to the cell size
+	FVector Scale(CellSize.X / 100.0f, CellSize.Y / 100.0f, 1);
+
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(NumRows * NumCols);
+	for (int i = 0; i < NumRows; i++) {
+		for (int j = 0; j < NumCols; j++) {
+			FVector Location = GetActorTransform().InverseTransformPosition(GetCellLocation(FSGridPosition(j, i)));
+			Transforms.Add(FTransform(FRotator::ZeroRotator, Location, Scale));
+		}
+	}
+
+	// Instance index matches the cell index, so custom data can be addressed by cell
+	CellMesh->AddInstances(Transforms, false);
 }
 
 void AGameGrid::OnConstruction(const FTransform& Transform) {
@@ -58,6 +243,15 @@ void AGameGrid::OnConstruction(const FTransform& Transform) {
 
 	GridActors.Empty();
 
+	UpdateCellSpacing();
+
+	if (bUseFlatStore) {
+		BuildCellInstances();
+		return;
+	}
+
+	CellMesh->ClearInstances();
+
 	if (!GridClass->IsValidLowLevel()) return;
 
 	AGameSlot* Slot = GridClass->GetDefaultObject<AGameSlot>();
@@ -90,6 +284,7 @@ void AGameGrid::OnConstruction(const FTransform& Transform) {
 			GameSlot->SetActorLabel(GridName.ToString());
 			GameSlot->GridPosition.Col = j;
 			GameSlot->GridPosition.Row = i;
+			GameSlot->Grid = this;
 		}
 	}
-}
\ No newline at end of file
+}
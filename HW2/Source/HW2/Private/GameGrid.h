@@ -4,11 +4,25 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Components/InstancedStaticMeshComponent.h"
 #include "GameSlot.h"
+#include "BoardContext.h"
 #include "GameGrid.generated.h"
 
+// One cell of the flat store: what it shows and who stands on it
+USTRUCT()
+struct FSGridCell {
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TEnumAsByte<EGridState> State = GS_Default;
+
+	UPROPERTY()
+	AUnitBase* Unit = nullptr;
+};
+
 UCLASS()
-class AGameGrid : public AActor
+class AGameGrid : public AActor, public FBoardContext
 {
 	GENERATED_BODY()
 	
@@ -17,6 +31,7 @@ public:
 	AGameGrid();
 
 	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void PostInitializeComponents() override;
 
 	UPROPERTY(EditAnywhere)
 	int NumCols;
@@ -29,11 +44,65 @@ public:
 
 	UPROPERTY(VisibleAnywhere)
 	TArray<UChildActorComponent*> GridActors;
-	AGameSlot* GetSlot(FSGridPosition& Position);
-	static AGameSlot* FindSlot(FSGridPosition& Position);
+	AGameSlot* GetSlot(const FSGridPosition& Position) const;
+
+	// Keep cells in a flat array drawn by CellMesh instead of spawning an AGameSlot actor per cell.
+	// GetSlot returns nullptr in this mode; use the cell functions below, which work in both modes.
+	UPROPERTY(EditAnywhere, Category = "Flat Store")
+	bool bUseFlatStore;
+
+	// Size of one cell in the flat store; slot mode takes it from GridClass's box
+	UPROPERTY(EditAnywhere, Category = "Flat Store")
+	FVector2D CellSize;
+
+	// Material for CellMesh; it should pick its look from PerInstanceCustomData[0], which holds the cell's EGridState
+	UPROPERTY(EditAnywhere, Category = "Flat Store")
+	UMaterialInterface* CellMaterial;
+
+	UPROPERTY(VisibleAnywhere)
+	UInstancedStaticMeshComponent* CellMesh;
+
+	AUnitBase* GetUnitAt(const FSGridPosition& Position) const;
+	void SetUnitAt(const FSGridPosition& Position, AUnitBase* Unit);
+
+	// FBoardContext
+	virtual bool IsValidPosition(const FSGridPosition& Position) const override;
+	virtual bool IsOccupied(const FSGridPosition& Position) const override;
+	virtual void MoveUnit(const FSGridPosition& Source, const FSGridPosition& Destination) override;
+	virtual EGridState GetCellState(const FSGridPosition& Position) const override;
+	virtual void SetCellState(const FSGridPosition& Position, EGridState NewState) override;
+
+	// Cell state changes are batched: slots queue here, flat store cells only write their custom data.
+	// Called from Tick after gameplay, so any number of changes in a frame costs one render update.
+	void QueueSlotUpdate(AGameSlot* Slot);
+	void FlushCellStates();
+
+	// World location of a cell's center
+	FVector GetCellLocation(const FSGridPosition& Position) const;
+
+	// Cell hit by a ray against the grid plane, e.g. the mouse ray from DeprojectMousePositionToWorld
+	bool GetCellFromRay(const FVector& Origin, const FVector& Direction, FSGridPosition& OutPosition) const;
+
+	AUnitBase* SpawnUnitAt(TSubclassOf<AUnitBase> UnitClass, const FSGridPosition& Position);
+
+	// Resize the flat store at runtime, clearing every cell. Slot actors are laid out in the editor,
+	// so in slot mode this only succeeds when the size already matches.
+	bool SetDimensions(int InNumRows, int InNumCols);
 
 private:
-	static AGameGrid* GameGrid;
+	int GetCellIndex(const FSGridPosition& Position) const { return Position.Row * NumCols + Position.Col; }
+	void UpdateCellSpacing();
+	void BuildCellInstances();
+
+	UPROPERTY()
+	TArray<FSGridCell> Cells;
+
+	UPROPERTY()
+	TArray<AGameSlot*> DirtySlots;
+
+	bool bCellRenderStateDirty;
+
+	FVector CellSpacing;
 
 protected:
 	// Called when the game starts or when spawned
@@ -8,6 +8,11 @@
 #include "UnitBase.h"
 #include "Command.h"
 #include "MoveCommand.h"
+#include "GridPathfinder.h"
+#include "CommandHistory.h"
+#include "AITurnPlanner.h"
+#include "LevelFile.h"
+#include "Engine/StreamableManager.h"
 #include "GameManager.generated.h"
 
 USTRUCT(BlueprintType)
@@ -30,6 +35,24 @@ struct FSLevelInfo {
 	TArray<FSUnitInfo> Units;
 };
 
+// Where every unit stood after a given number of commands
+struct FBoardCheckpoint {
+	int64 Sequence;
+	TArray<TPair<TWeakObjectPtr<AUnitBase>, FSGridPosition>> UnitPositions;
+};
+
+// Outcome of reading a level file on a worker thread
+struct FLevelFileReadResult {
+	bool bSuccess = false;
+	FLevelFileData Data;
+	FString Error;
+};
+
+struct FPendingUnitSpawn {
+	TSubclassOf<AUnitBase> UnitClass;
+	FSGridPosition Position;
+};
+
 UCLASS()
 class AGameManager : public AActor
 {
@@ -41,6 +64,9 @@ public:
 
 	void OnActorClicked(AActor* Actor, FKey button);
 
+	// Click on a grid cell, from a slot actor or resolved from the mouse ray in flat store mode
+	void OnCellClicked(const FSGridPosition& Position, FKey button);
+
 	void CreateLevelActors(FSLevelInfo& Info);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
@@ -52,7 +78,62 @@ public:
 	UPROPERTY(EditAnywhere)
 	AGameGrid* GameGrid;
 
+	// Level file loaded at BeginPlay instead of Levels[CurrentLevel]; relative paths start at the project directory
+	UPROPERTY(EditAnywhere, Category = "Level File")
+	FString LevelFile;
+
+	// Milliseconds per frame spent spawning units while a level builds; at least one unit spawns per frame
+	UPROPERTY(EditAnywhere, Category = "Level File")
+	float UnitSpawnBudgetMs;
+
+	// Read a level file in the background, then load its unit classes and spawn the units over several frames
+	void LoadLevelFile(const FString& Path);
+
+	// Write the current board; .json for JSON, anything else for the binary format
+	bool SaveLevelFile(const FString& Path);
+
+	bool IsLoadingLevel() const { return bLoadingLevel; }
+
+	// How many steps the player's unit may walk in one move
+	UPROPERTY(EditAnywhere)
+	int MoveRange;
+
+	// Commands kept for undo/redo; older ones can only be reached through checkpoints
+	UPROPERTY(EditAnywhere, Category = "History")
+	int HistoryDepth;
+
+	// Commands between board checkpoints
+	UPROPERTY(EditAnywhere, Category = "History")
+	int CheckpointInterval;
+
+	UPROPERTY(EditAnywhere, Category = "History")
+	int MaxCheckpoints;
+
+	// Units not controlled by the player take a turn after each player move
+	UPROPERTY(EditAnywhere, Category = "AI")
+	bool bEnableAI;
+
+	UPROPERTY(EditAnywhere, Category = "AI")
+	int AISearchDepth;
+
+	// Seconds the search may take before it settles for the deepest finished iteration
+	UPROPERTY(EditAnywhere, Category = "AI")
+	float AITimeBudget;
+
+	// True while the AI's search runs in the background; the board must not change meanwhile
+	bool IsAIThinking() const { return AIPlan.IsValid(); }
+
+	// Player input is ignored while the AI thinks or a level is still being built
+	bool IsBoardBusy() const { return IsAIThinking() || IsLoadingLevel(); }
+
+	// Execute a command and record it for undo
+	void SubmitCommand(const FCommandRecord& Record);
+
 	bool UndoLastMove();
+	bool RedoMove();
+
+	// Restore the board to the latest checkpoint before the current state, even past the undo history
+	bool RevertToCheckpoint();
 
 protected:
 	// Called when the game starts or when spawned
@@ -63,8 +144,57 @@ public:
 	virtual void Tick(float DeltaTime) override;
 
 private:
+	// Rebuild the player's reachability field and repaint the move-range highlights
+	void RefreshMoveRange();
+
+	// State a cell has in the level itself, under any move-range highlight
+	EGridState GetBaseCellState(const FSGridPosition& Position) const;
+
+	// Commands are built on the stack from their record, so replaying history allocates nothing
+	void ApplyCommand(const FCommandRecord& Record, bool bRevert);
+
+	void SaveCheckpoint();
+
+	// Snapshot the board and start the AI's search on a worker thread
+	void StartAITurn();
+
+	// Apply the AI's move once its search has finished
+	void FinishAITurn(const FAIPlanResult& Result);
+
+	void OnLevelFileRead(FLevelFileReadResult&& Result);
+	void OnUnitClassesLoaded();
+
+	// Spawn queued units until the frame budget runs out; finishes the level once the queue is empty
+	void SpawnPendingUnits();
+	void FinishLevelLoad();
+
 	AUnitBase* ThePlayer;
-	TArray<TSharedRef<Command>> CommandPool;
-	TSharedPtr<Command> CurrentCommand;
+	FGridPathfinder Pathfinder;
+	TArray<FSGridPosition> HighlightedCells;
+
+	// Cell states from the level file, row-major; empty when every cell is GS_Default. Highlights are drawn
+	// over these and cleared back to them, and saving writes these rather than what the grid shows
+	TArray<uint8> BaseCellStates;
+
+	UPROPERTY()
+	TArray<AUnitBase*> Units;
+
+	FCommandHistory History;
+	TArray<FBoardCheckpoint> Checkpoints;
+
+	TFuture<FAIPlanResult> AIPlan;
+
+	bool bLoadingLevel;
+	double LevelLoadStartTime;
+	int LevelLoadFrames;
+	FString LoadingLevelPath;
+	TFuture<FLevelFileReadResult> PendingLevelRead;
+	FLevelFileData PendingLevel;
+
+	// Keeps the file's unit classes loaded while their units spawn
+	TSharedPtr<FStreamableHandle> UnitClassHandle;
+
+	TArray<FPendingUnitSpawn> PendingSpawns;
+	int32 NextPendingSpawn;
 
 };
@@ -3,9 +3,10 @@
 
 #include "GameSlot.h"
 #include "TBPlayerController.h"
+#include "GameGrid.h"
 
 // Sets default values
-AGameSlot::AGameSlot()
+AGameSlot::AGameSlot() : GridState(GS_Default), AppliedState(GS_Default), Grid(nullptr), bStateQueued(false)
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -38,8 +39,15 @@ void AGameSlot::BeginPlay()
 {
 	Super::BeginPlay();
 
+	// Slots are child actors of their grid, in case the pointer didn't survive the child actor being respawned
+	if (!Grid) Grid = Cast<AGameGrid>(GetParentActor());
+
 	OnClicked.AddUniqueDynamic(this, &AGameSlot::OnGridClicked);
-	SetState(GS_Default);
+
+	// Start from the default look, whatever material the plane has in the blueprint
+	GridState = GS_Default;
+	AppliedState = GS_Default;
+	Plane->SetMaterial(0, DefaultMaterial);
 }
 
 // Called every frame
@@ -52,6 +60,15 @@ void AGameSlot::Tick(float DeltaTime)
 void AGameSlot::SetState(EGridState NewState) {
 	GridState = NewState;
 
+	if (Grid) Grid->QueueSlotUpdate(this);
+	else ApplyState();
+}
+
+void AGameSlot::ApplyState() {
+	// A state that flipped back within the frame leaves the material alone
+	if (AppliedState == GridState) return;
+	AppliedState = GridState;
+
 	switch (GridState) {
 	case GS_Default:
 		Plane->SetMaterial(0, DefaultMaterial);
@@ -70,12 +87,13 @@ void AGameSlot::SetState(EGridState NewState) {
 
 void AGameSlot::SpawnUnitHere(TSubclassOf<AUnitBase>& UnitClass) {
 	FVector Location = GetActorLocation();
-	AUnitBase* NewUnit = Cast<AUnitBase>(GWorld->SpawnActor(UnitClass, &Location));
+	AUnitBase* NewUnit = Cast<AUnitBase>(GetWorld()->SpawnActor(UnitClass, &Location));
 	if (NewUnit) NewUnit->AssignToSlot(this);
 }
 
 void AGameSlot::OnGridClicked(AActor* TouchedActor, FKey ButtonPressed) {
-	if (auto PlayerController = GWorld->GetFirstPlayerController<ATBPlayerController>()) {
+	// The slot's own world, so each PIE instance routes clicks to its own controller
+	if (auto PlayerController = GetWorld()->GetFirstPlayerController<ATBPlayerController>()) {
 		PlayerController->OnActorClicked(this, ButtonPressed);
 	}
 }
\ No newline at end of file
@@ -7,30 +7,11 @@
 #include "GameFramework/Actor.h"
 #include "Components/BoxComponent.h"
 #include "Components/StaticMeshComponent.h"
+#include "GridTypes.h"
 #include "UnitBase.h"
 #include "GameSlot.generated.h"
 
-USTRUCT(BlueprintType)
-struct FSGridPosition {
-	GENERATED_BODY()
-
-	FSGridPosition() {}
-	FSGridPosition(int col, int row) : Col(col), Row(row) {}
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	uint8 Col;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	uint8 Row;
-};
-
-UENUM(Blueprintable)
-enum EGridState {
-GS_Default,
-GS_Highlighted,
-GS_Offensive,
-GS_Supportive
-};
+class AGameGrid;
 
 UCLASS()
 class AGameSlot : public AActor
@@ -40,6 +21,9 @@ class AGameSlot : public AActor
 private:
 	EGridState GridState;
 
+	// State whose material the plane currently shows
+	EGridState AppliedState;
+
 	UPROPERTY()
 	UMaterialInterface* DefaultMaterial;
 
@@ -63,6 +47,10 @@ public:
 	UPROPERTY(BlueprintReadWrite)
 	FSGridPosition GridPosition;
 
+	// The grid that laid this slot out
+	UPROPERTY(VisibleAnywhere)
+	AGameGrid* Grid;
+
 	UPROPERTY(VisibleAnywhere)
 	UStaticMeshComponent* Plane;
 
@@ -72,9 +60,18 @@ public:
 	UPROPERTY(VisibleAnywhere)
 	AUnitBase* Unit;
 
+	// Changes the state right away; the material follows when the grid flushes its batch
 	UFUNCTION()
 	void SetState(EGridState NewState);
 
+	EGridState GetState() const { return GridState; }
+
+	// Swap the plane's material to match the state, if it doesn't already
+	void ApplyState();
+
+	// Set while the slot waits in its grid's batch
+	bool bStateQueued;
+
 	void SpawnUnitHere(TSubclassOf<AUnitBase>& UnitClass);
 
 protected:
@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridPathfinder.h"
+#include "GameGrid.h"
+#include "Algo/Reverse.h"
+#include "HAL/IConsoleManager.h"
+
+FGridPathfinder::FGridPathfinder() : NumRows(0), NumCols(0), SearchGeneration(0), ReachGeneration(0), ExpandedNodes(0)
+{
+
+}
+
+void FGridPathfinder::Init(int InNumRows, int InNumCols) {
+	const int32 NumCells = InNumRows * InNumCols;
+
+	// Same size keeps the stamps, so a new snapshot doesn't throw away the cached field's memory
+	if (InNumRows != NumRows || InNumCols != NumCols) {
+		NumRows = InNumRows;
+		NumCols = InNumCols;
+
+		GScore.SetNumUninitialized(NumCells);
+		Parent.SetNumUninitialized(NumCells);
+		SearchStamp.SetNumZeroed(NumCells);
+		ReachCost.SetNumUninitialized(NumCells);
+		ReachStamp.SetNumZeroed(NumCells);
+
+		// Stamp 0 is never a live generation, so a zeroed array reads as unvisited
+		SearchGeneration = 0;
+		ReachGeneration = 0;
+		ReachableCells.Reset();
+		BorderingBlockedCells.Reset();
+	}
+
+	Blocked.Init(false, NumCells);
+}
+
+void FGridPathfinder::CaptureOccupancy(AGameGrid& Grid) {
+	Init(Grid.NumRows, Grid.NumCols);
+
+	for (int i = 0; i < NumRows; i++) {
+		for (int j = 0; j < NumCols; j++) {
+			FSGridPosition Position(j, i);
+			if (Grid.GetUnitAt(Position)) {
+				Blocked[ToIndex(Position)] = true;
+			}
+		}
+	}
+}
+
+void FGridPathfinder::SetBlocked(const FSGridPosition& Position, bool bBlocked) {
+	if (IsValidPosition(Position)) Blocked[ToIndex(Position)] = bBlocked;
+}
+
+bool FGridPathfinder::IsBlocked(const FSGridPosition& Position) const {
+	return !IsValidPosition(Position) || Blocked[ToIndex(Position)];
+}
+
+uint32 FGridPathfinder::NextGeneration(uint32& Generation, TArray<uint32>& Stamps) {
+	if (++Generation == 0) {
+		FMemory::Memzero(Stamps.GetData(), Stamps.Num() * sizeof(uint32));
+		Generation = 1;
+	}
+	return Generation;
+}
+
+int FGridPathfinder::Heuristic(int32 Index, int32 GoalIndex) const {
+	return FMath::Abs(Index / NumCols - GoalIndex / NumCols) + FMath::Abs(Index % NumCols - GoalIndex % NumCols);
+}
+
+template <typename FunctorType>
+void FGridPathfinder::ForEachNeighbour(int32 Index, FunctorType&& Functor) const {
+	const int Row = Index / NumCols;
+	const int Col = Index % NumCols;
+
+	if (Row > 0) Functor(Index - NumCols);
+	if (Row < NumRows - 1) Functor(Index + NumCols);
+	if (Col > 0) Functor(Index - 1);
+	if (Col < NumCols - 1) Functor(Index + 1);
+}
+
+bool FGridPathfinder::FindPath(const FSGridPosition& Start, const FSGridPosition& Goal, TArray<FSGridPosition>& OutPath) {
+	OutPath.Reset();
+	ExpandedNodes = 0;
+
+	if (!IsValidPosition(Start) || IsBlocked(Goal)) return false;
+
+	const uint32 Generation = NextGeneration(SearchGeneration, SearchStamp);
+	const int32 StartIndex = ToIndex(Start);
+	const int32 GoalIndex = ToIndex(Goal);
+
+	auto Less = [](const FOpenNode& A, const FOpenNode& B) { return A.Cost < B.Cost; };
+
+	OpenHeap.Reset();
+	GScore[StartIndex] = 0;
+	Parent[StartIndex] = INDEX_NONE;
+	SearchStamp[StartIndex] = Generation;
+	OpenHeap.HeapPush({ Heuristic(StartIndex, GoalIndex), StartIndex }, Less);
+
+	while (OpenHeap.Num() > 0) {
+		FOpenNode Node;
+		OpenHeap.HeapPop(Node, Less, EAllowShrinking::No);
+
+		// Stale entry left behind when the cell was reached more cheaply later
+		const int32 G = GScore[Node.Index];
+		if (Node.Cost > G + Heuristic(Node.Index, GoalIndex)) continue;
+
+		ExpandedNodes++;
+
+		if (Node.Index == GoalIndex) {
+			for (int32 Index = GoalIndex; Index != StartIndex; Index = Parent[Index]) {
+				OutPath.Add(ToPosition(Index));
+			}
+			Algo::Reverse(OutPath);
+			return true;
+		}
+
+		ForEachNeighbour(Node.Index, [&](int32 Next) {
+			if (Blocked[Next]) return;
+
+			const int32 NextG = G + 1;
+			if (SearchStamp[Next] == Generation && GScore[Next] <= NextG) return;
+
+			SearchStamp[Next] = Generation;
+			GScore[Next] = NextG;
+			Parent[Next] = Node.Index;
+			OpenHeap.HeapPush({ NextG + Heuristic(Next, GoalIndex), Next }, Less);
+		});
+	}
+
+	return false;
+}
+
+void FGridPathfinder::BuildReachability(const FSGridPosition& Origin, int MaxCost) {
+	ReachableCells.Reset();
+	BorderingBlockedCells.Reset();
+	ExpandedNodes = 0;
+
+	if (!IsValidPosition(Origin)) return;
+
+	const uint32 Generation = NextGeneration(ReachGeneration, ReachStamp);
+	const int32 OriginIndex = ToIndex(Origin);
+
+	ReachStamp[OriginIndex] = Generation;
+	ReachCost[OriginIndex] = 0;
+	ReachableCells.Add(OriginIndex);
+
+	// Every step costs the same, so a breadth-first sweep gives exact costs; ReachableCells doubles as the queue
+	for (int32 Head = 0; Head < ReachableCells.Num(); Head++) {
+		const int32 Index = ReachableCells[Head];
+		const int32 Cost = ReachCost[Index];
+		ExpandedNodes++;
+
+		ForEachNeighbour(Index, [&](int32 Next) {
+			if (ReachStamp[Next] == Generation) return;
+
+			if (Blocked[Next]) {
+				// Remember occupied neighbours once; INDEX_NONE keeps them out of IsReachable
+				ReachStamp[Next] = Generation;
+				ReachCost[Next] = INDEX_NONE;
+				BorderingBlockedCells.Add(Next);
+				return;
+			}
+
+			if (Cost + 1 > MaxCost) return;
+
+			ReachStamp[Next] = Generation;
+			ReachCost[Next] = Cost + 1;
+			ReachableCells.Add(Next);
+		});
+	}
+}
+
+bool FGridPathfinder::IsReachable(const FSGridPosition& Position) const {
+	return GetReachCost(Position) != INDEX_NONE;
+}
+
+int FGridPathfinder::GetReachCost(const FSGridPosition& Position) const {
+	if (!IsValidPosition(Position) || ReachGeneration == 0) return INDEX_NONE;
+
+	const int32 Index = ToIndex(Position);
+	return ReachStamp[Index] == ReachGeneration ? ReachCost[Index] : INDEX_NONE;
+}
+
+// Usage: HW2.BenchmarkPathfinding [Size=256] [Queries=1000] [BlockedPercent=25] [Seed=1]
+static void BenchmarkPathfinding(const TArray<FString>& Args) {
+	const int Size = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 256, 2, 256);
+	const int Queries = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1000);
+	const int BlockedPercent = FMath::Clamp(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 25, 0, 90);
+	FRandomStream Random(Args.Num() > 3 ? FCString::Atoi(*Args[3]) : 1);
+
+	FGridPathfinder Pathfinder;
+	Pathfinder.Init(Size, Size);
+	for (int i = 0; i < Size; i++) {
+		for (int j = 0; j < Size; j++) {
+			if (Random.RandRange(0, 99) < BlockedPercent) Pathfinder.SetBlocked(FSGridPosition(j, i), true);
+		}
+	}
+
+	TArray<FSGridPosition> Path;
+	Path.Reserve(Size * 4);
+	int Found = 0;
+	int64 Expanded = 0;
+
+	const double PathStart = FPlatformTime::Seconds();
+	for (int Query = 0; Query < Queries; Query++) {
+		FSGridPosition Start(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1));
+		FSGridPosition Goal(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1));
+		if (Pathfinder.FindPath(Start, Goal, Path)) Found++;
+		Expanded += Pathfinder.GetExpandedNodes();
+	}
+	const double PathSeconds = FPlatformTime::Seconds() - PathStart;
+
+	const double FieldStart = FPlatformTime::Seconds();
+	Pathfinder.BuildReachability(FSGridPosition(Size / 2, Size / 2), Size * 2);
+	const double FieldSeconds = FPlatformTime::Seconds() - FieldStart;
+
+	UE_LOG(LogTemp, Warning, TEXT("Pathfinding %dx%d, %d%% blocked: %d A* queries (%d found) in %.2f ms, %.3f ms/query, %.1fM nodes/s"),
+		Size, Size, BlockedPercent, Queries, Found, PathSeconds * 1000.0, PathSeconds * 1000.0 / Queries, Expanded / FMath::Max(PathSeconds, 1e-9) / 1e6);
+	UE_LOG(LogTemp, Warning, TEXT("Reachability field from the center: %d cells in %.3f ms"),
+		Pathfinder.GetReachableCells().Num(), FieldSeconds * 1000.0);
+}
+
+static FAutoConsoleCommand BenchmarkPathfindingCommand(
+	TEXT("HW2.BenchmarkPathfinding"),
+	TEXT("Time random A* queries and a reachability field on a generated grid. Args: [Size=256] [Queries=1000] [BlockedPercent=25] [Seed=1]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkPathfinding));
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridTypes.h"
+
+class AGameGrid;
+
+/**
+ * Pathfinding over a snapshot of the grid's occupancy: cells holding a unit are blocked, moves are
+ * the four orthogonal steps at cost 1. Scratch buffers are sized once per grid and reused; generation
+ * stamps mark which entries belong to the current search, so nothing is cleared between searches.
+ */
+class FGridPathfinder
+{
+public:
+	FGridPathfinder();
+
+	// Size the buffers for a grid; every cell starts free
+	void Init(int InNumRows, int InNumCols);
+
+	// Reset to the grid's dimensions and block every cell that holds a unit
+	void CaptureOccupancy(AGameGrid& Grid);
+
+	void SetBlocked(const FSGridPosition& Position, bool bBlocked);
+	bool IsBlocked(const FSGridPosition& Position) const;
+
+	// A* from Start to Goal; OutPath runs from the first step to Goal. Start may be occupied (it's the mover)
+	bool FindPath(const FSGridPosition& Start, const FSGridPosition& Goal, TArray<FSGridPosition>& OutPath);
+
+	// Flood the cells reachable from Origin within MaxCost steps; the result stays cached until the next call
+	void BuildReachability(const FSGridPosition& Origin, int MaxCost);
+
+	bool IsReachable(const FSGridPosition& Position) const;
+	int GetReachCost(const FSGridPosition& Position) const;
+
+	// Cell indices of the last reachability field, Origin first
+	const TArray<int32>& GetReachableCells() const { return ReachableCells; }
+
+	// Occupied cells bordering the last field, i.e. units the mover could reach to attack or support
+	const TArray<int32>& GetBorderingBlockedCells() const { return BorderingBlockedCells; }
+
+	// Cells expanded by the last FindPath or BuildReachability, for profiling
+	int32 GetExpandedNodes() const { return ExpandedNodes; }
+
+	int GetNumRows() const { return NumRows; }
+	int GetNumCols() const { return NumCols; }
+
+	FSGridPosition ToPosition(int32 Index) const { return FSGridPosition(Index % NumCols, Index / NumCols); }
+	int32 ToIndex(const FSGridPosition& Position) const { return Position.Row * NumCols + Position.Col; }
+	bool IsValidPosition(const FSGridPosition& Position) const { return Position.Row < NumRows && Position.Col < NumCols; }
+
+private:
+	struct FOpenNode
+	{
+		int32 Cost;
+		int32 Index;
+	};
+
+	int Heuristic(int32 Index, int32 GoalIndex) const;
+
+	// Bump a generation counter, clearing the stamps only when it wraps around
+	static uint32 NextGeneration(uint32& Generation, TArray<uint32>& Stamps);
+
+	template <typename FunctorType>
+	void ForEachNeighbour(int32 Index, FunctorType&& Functor) const;
+
+	int NumRows;
+	int NumCols;
+	TBitArray<> Blocked;
+
+	// A* scratch
+	TArray<int32> GScore;
+	TArray<int32> Parent;
+	TArray<uint32> SearchStamp;
+	TArray<FOpenNode> OpenHeap;
+	uint32 SearchGeneration;
+
+	// Reachability field
+	TArray<int32> ReachCost;
+	TArray<uint32> ReachStamp;
+	TArray<int32> ReachableCells;
+	TArray<int32> BorderingBlockedCells;
+	uint32 ReachGeneration;
+
+	int32 ExpandedNodes;
+};
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridTypes.generated.h"
+
+USTRUCT(BlueprintType)
+struct FSGridPosition {
+	GENERATED_BODY()
+
+	FSGridPosition() {}
+	FSGridPosition(int col, int row) : Col(col), Row(row) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	uint8 Col;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	uint8 Row;
+};
+
+UENUM(Blueprintable)
+enum EGridState {
+GS_Default,
+GS_Highlighted,
+GS_Offensive,
+GS_Supportive
+};
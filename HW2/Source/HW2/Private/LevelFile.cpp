@@ -0,0 +1,381 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LevelFile.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	const uint32 BinaryMagic = 0x4C325748; // "HW2L"
+	const uint16 BinaryVersion = 1;
+	const int32 JsonVersion = 1;
+
+	// FSGridPosition holds a uint8 per axis
+	const int MaxGridSize = 256;
+	const uint8 NumGridStates = GS_Supportive + 1;
+
+	bool IsJsonPath(const FString& Path) {
+		return FPaths::GetExtension(Path).Equals(TEXT("json"), ESearchCase::IgnoreCase);
+	}
+}
+
+void FLevelFile::SaveJson(const FLevelFileData& Data, FString& OutText) {
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("version"), JsonVersion);
+	Root->SetNumberField(TEXT("rows"), Data.NumRows);
+	Root->SetNumberField(TEXT("cols"), Data.NumCols);
+
+	// One digit per cell keeps big boards readable as a block of text
+	if (Data.CellStates.Num() > 0) {
+		FString Cells;
+		Cells.Reserve(Data.CellStates.Num());
+		for (uint8 State : Data.CellStates) {
+			Cells.AppendChar(TEXT('0') + State);
+		}
+		Root->SetStringField(TEXT("cells"), Cells);
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Units;
+	Units.Reserve(Data.Units.Num());
+	for (const FLevelFileUnit& Unit : Data.Units) {
+		TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+		Entry->SetStringField(TEXT("class"), Unit.ClassPath);
+		Entry->SetNumberField(TEXT("row"), Unit.Position.Row);
+		Entry->SetNumberField(TEXT("col"), Unit.Position.Col);
+		Units.Add(MakeShared<FJsonValueObject>(Entry));
+	}
+	Root->SetArrayField(TEXT("units"), Units);
+
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutText);
+	FJsonSerializer::Serialize(Root, Writer);
+}
+
+bool FLevelFile::LoadJson(const FString& Text, FLevelFileData& OutData, FString& OutError) {
+	OutData = FLevelFileData();
+
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Text);
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid()) {
+		OutError = FString::Printf(TEXT("Invalid JSON: %s"), *Reader->GetErrorMessage());
+		return false;
+	}
+
+	int32 Version = 0;
+	if (!Root->TryGetNumberField(TEXT("version"), Version) || Version > JsonVersion) {
+		OutError = FString::Printf(TEXT("Unsupported level version %d"), Version);
+		return false;
+	}
+
+	if (!Root->TryGetNumberField(TEXT("rows"), OutData.NumRows) || !Root->TryGetNumberField(TEXT("cols"), OutData.NumCols)) {
+		OutError = TEXT("Missing grid dimensions");
+		return false;
+	}
+
+	FString Cells;
+	if (Root->TryGetStringField(TEXT("cells"), Cells)) {
+		OutData.CellStates.Reserve(Cells.Len());
+		for (TCHAR Char : Cells) {
+			OutData.CellStates.Add(static_cast<uint8>(Char - TEXT('0')));
+		}
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Units = nullptr;
+	if (Root->TryGetArrayField(TEXT("units"), Units)) {
+		OutData.Units.Reserve(Units->Num());
+		for (const TSharedPtr<FJsonValue>& Value : *Units) {
+			const TSharedPtr<FJsonObject>* Entry = nullptr;
+			int32 Row = 0, Col = 0;
+			if (!Value->TryGetObject(Entry)
+				|| !(*Entry)->TryGetNumberField(TEXT("row"), Row) || !(*Entry)->TryGetNumberField(TEXT("col"), Col)
+				|| Row < 0 || Row >= MaxGridSize || Col < 0 || Col >= MaxGridSize) {
+				OutError = FString::Printf(TEXT("Bad unit entry %d"), OutData.Units.Num());
+				return false;
+			}
+
+			FLevelFileUnit& Unit = OutData.Units.AddDefaulted_GetRef();
+			(*Entry)->TryGetStringField(TEXT("class"), Unit.ClassPath);
+			Unit.Position = FSGridPosition(Col, Row);
+		}
+	}
+
+	return Validate(OutData, OutError);
+}
+
+void FLevelFile::SaveBinary(const FLevelFileData& Data, TArray<uint8>& OutBytes) {
+	OutBytes.Reset();
+	FMemoryWriter Ar(OutBytes);
+
+	uint32 Magic = BinaryMagic;
+	uint16 Version = BinaryVersion;
+	uint16 NumRows = Data.NumRows;
+	uint16 NumCols = Data.NumCols;
+	Ar << Magic << Version << NumRows << NumCols;
+
+	// Boards are mostly default cells, so runs of equal states shrink them to a few bytes
+	TArray<TPair<uint8, uint32>> Runs;
+	for (uint8 State : Data.CellStates) {
+		if (Runs.Num() > 0 && Runs.Last().Key == State) Runs.Last().Value++;
+		else Runs.Emplace(State, 1);
+	}
+
+	uint32 NumRuns = Runs.Num();
+	Ar.SerializeIntPacked(NumRuns);
+	for (TPair<uint8, uint32>& Run : Runs) {
+		Ar << Run.Key;
+		Ar.SerializeIntPacked(Run.Value);
+	}
+
+	// Unit classes repeat a lot; store each path once and refer to it by index
+	TArray<FString> Classes;
+	TArray<uint32> ClassIndices;
+	ClassIndices.Reserve(Data.Units.Num());
+	for (const FLevelFileUnit& Unit : Data.Units) {
+		ClassIndices.Add(Classes.AddUnique(Unit.ClassPath));
+	}
+
+	uint32 NumClasses = Classes.Num();
+	Ar.SerializeIntPacked(NumClasses);
+	for (FString& ClassPath : Classes) {
+		Ar << ClassPath;
+	}
+
+	uint32 NumUnits = Data.Units.Num();
+	Ar.SerializeIntPacked(NumUnits);
+	for (int32 i = 0; i < Data.Units.Num(); i++) {
+		FSGridPosition Position = Data.Units[i].Position;
+		Ar.SerializeIntPacked(ClassIndices[i]);
+		Ar << Position.Col << Position.Row;
+	}
+}
+
+bool FLevelFile::LoadBinary(const TArray<uint8>& Bytes, FLevelFileData& OutData, FString& OutError) {
+	OutData = FLevelFileData();
+	FMemoryReader Ar(Bytes);
+
+	uint32 Magic = 0;
+	uint16 Version = 0, NumRows = 0, NumCols = 0;
+	Ar << Magic << Version << NumRows << NumCols;
+	if (Ar.IsError() || Magic != BinaryMagic || Version > BinaryVersion) {
+		OutError = TEXT("Not an HW2 level file, or a newer version");
+		return false;
+	}
+
+	OutData.NumRows = NumRows;
+	OutData.NumCols = NumCols;
+	const int32 NumCells = OutData.NumRows * OutData.NumCols;
+
+	uint32 NumRuns = 0;
+	Ar.SerializeIntPacked(NumRuns);
+	if (NumRuns > 0) OutData.CellStates.Reserve(NumCells);
+	for (uint32 i = 0; i < NumRuns && !Ar.IsError(); i++) {
+		uint8 State = 0;
+		uint32 Count = 0;
+		Ar << State;
+		Ar.SerializeIntPacked(Count);
+
+		// Guard the allocation against a corrupt count
+		if (OutData.CellStates.Num() + (int64)Count > NumCells) {
+			OutError = TEXT("Cell states overrun the grid");
+			return false;
+		}
+		for (uint32 j = 0; j < Count; j++) OutData.CellStates.Add(State);
+	}
+
+	uint32 NumClasses = 0;
+	Ar.SerializeIntPacked(NumClasses);
+	TArray<FString> Classes;
+	for (uint32 i = 0; i < NumClasses && !Ar.IsError(); i++) {
+		Ar << Classes.AddDefaulted_GetRef();
+	}
+
+	uint32 NumUnits = 0;
+	Ar.SerializeIntPacked(NumUnits);
+	if (NumUnits > (uint32)NumCells) {
+		OutError = TEXT("More units than cells");
+		return false;
+	}
+
+	OutData.Units.Reserve(NumUnits);
+	for (uint32 i = 0; i < NumUnits && !Ar.IsError(); i++) {
+		uint32 ClassIndex = 0;
+		FLevelFileUnit& Unit = OutData.Units.AddDefaulted_GetRef();
+		Ar.SerializeIntPacked(ClassIndex);
+		Ar << Unit.Position.Col << Unit.Position.Row;
+
+		if (!Classes.IsValidIndex(ClassIndex)) {
+			OutError = FString::Printf(TEXT("Unit %u refers to unknown class %u"), i, ClassIndex);
+			return false;
+		}
+		Unit.ClassPath = Classes[ClassIndex];
+	}
+
+	if (Ar.IsError()) {
+		OutError = TEXT("Level file is truncated");
+		return false;
+	}
+
+	return Validate(OutData, OutError);
+}
+
+bool FLevelFile::SaveToFile(const FLevelFileData& Data, const FString& Path) {
+	if (IsJsonPath(Path)) {
+		FString Text;
+		SaveJson(Data, Text);
+		return FFileHelper::SaveStringToFile(Text, *Path);
+	}
+
+	TArray<uint8> Bytes;
+	SaveBinary(Data, Bytes);
+	return FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+bool FLevelFile::LoadFromFile(const FString& Path, FLevelFileData& OutData, FString& OutError) {
+	if (IsJsonPath(Path)) {
+		FString Text;
+		if (!FFileHelper::LoadFileToString(Text, *Path)) {
+			OutError = FString::Printf(TEXT("Can't read %s"), *Path);
+			return false;
+		}
+		return LoadJson(Text, OutData, OutError);
+	}
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path)) {
+		OutError = FString::Printf(TEXT("Can't read %s"), *Path);
+		return false;
+	}
+	return LoadBinary(Bytes, OutData, OutError);
+}
+
+bool FLevelFile::Validate(const FLevelFileData& Data, FString& OutError) {
+	if (Data.NumRows <= 0 || Data.NumCols <= 0 || Data.NumRows > MaxGridSize || Data.NumCols > MaxGridSize) {
+		OutError = FString::Printf(TEXT("Bad grid size %dx%d"), Data.NumRows, Data.NumCols);
+		return false;
+	}
+
+	const int32 NumCells = Data.NumRows * Data.NumCols;
+	if (Data.CellStates.Num() != 0 && Data.CellStates.Num() != NumCells) {
+		OutError = FString::Printf(TEXT("%d cell states for %d cells"), Data.CellStates.Num(), NumCells);
+		return false;
+	}
+
+	for (uint8 State : Data.CellStates) {
+		if (State >= NumGridStates) {
+			OutError = FString::Printf(TEXT("Unknown cell state %d"), State);
+			return false;
+		}
+	}
+
+	TBitArray<> Occupied(false, NumCells);
+	for (const FLevelFileUnit& Unit : Data.Units) {
+		if (Unit.Position.Row >= Data.NumRows || Unit.Position.Col >= Data.NumCols) {
+			OutError = FString::Printf(TEXT("Unit at [%d,%d] is off the grid"), Unit.Position.Row, Unit.Position.Col);
+			return false;
+		}
+
+		const int32 Index = Unit.Position.Row * Data.NumCols + Unit.Position.Col;
+		if (Occupied[Index]) {
+			OutError = FString::Printf(TEXT("Two units at [%d,%d]"), Unit.Position.Row, Unit.Position.Col);
+			return false;
+		}
+		Occupied[Index] = true;
+	}
+
+	return true;
+}
+
+// Random board with Units units of ClassPath on distinct cells
+static FLevelFileData GenerateLevel(int Size, int Units, const FString& ClassPath, int32 Seed) {
+	FRandomStream Random(Seed);
+
+	FLevelFileData Data;
+	Data.NumRows = Size;
+	Data.NumCols = Size;
+
+	// Partial shuffle of the cell indices picks distinct cells without retries
+	TArray<int32> Cells;
+	Cells.SetNumUninitialized(Size * Size);
+	for (int32 i = 0; i < Cells.Num(); i++) Cells[i] = i;
+
+	const int32 NumUnits = FMath::Min(Units, Cells.Num());
+	Data.Units.Reserve(NumUnits);
+	for (int32 i = 0; i < NumUnits; i++) {
+		Cells.Swap(i, Random.RandRange(i, Cells.Num() - 1));
+		Data.Units.Add({ ClassPath, FSGridPosition(Cells[i] % Size, Cells[i] / Size) });
+	}
+
+	return Data;
+}
+
+// Usage: HW2.GenerateLevel <Path> <ClassPath> [Size=64] [Units=256] [Seed=1]
+static void GenerateLevelCommand(const TArray<FString>& Args) {
+	if (Args.Num() < 2) {
+		UE_LOG(LogTemp, Warning, TEXT("Usage: HW2.GenerateLevel <Path> <ClassPath> [Size=64] [Units=256] [Seed=1]"));
+		return;
+	}
+
+	const int Size = FMath::Clamp(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 64, 1, MaxGridSize);
+	const int Units = FMath::Max(0, Args.Num() > 3 ? FCString::Atoi(*Args[3]) : 256);
+	const int32 Seed = Args.Num() > 4 ? FCString::Atoi(*Args[4]) : 1;
+
+	const FLevelFileData Data = GenerateLevel(Size, Units, Args[1], Seed);
+	if (FLevelFile::SaveToFile(Data, Args[0])) {
+		UE_LOG(LogTemp, Warning, TEXT("Wrote %dx%d level with %d units to %s"), Size, Size, Data.Units.Num(), *Args[0]);
+	}
+	else {
+		UE_LOG(LogTemp, Error, TEXT("Failed to write %s"), *Args[0]);
+	}
+}
+
+static FAutoConsoleCommand GenerateLevelConsoleCommand(
+	TEXT("HW2.GenerateLevel"),
+	TEXT("Write a random level file; .json for JSON, anything else for binary. Args: <Path> <ClassPath> [Size=64] [Units=256] [Seed=1]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&GenerateLevelCommand));
+
+// Usage: HW2.BenchmarkLevelFile [Size=256] [Units=4096] [Seed=1]
+static void BenchmarkLevelFile(const TArray<FString>& Args) {
+	const int Size = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 256, 1, MaxGridSize);
+	const int Units = FMath::Max(0, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 4096);
+	const int32 Seed = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1;
+
+	FLevelFileData Data = GenerateLevel(Size, Units, TEXT("/Game/Units/BP_Unit.BP_Unit_C"), Seed);
+	Data.CellStates.Init(GS_Default, Size * Size);
+
+	FLevelFileData Loaded;
+	FString Error;
+
+	double Start = FPlatformTime::Seconds();
+	FString Text;
+	FLevelFile::SaveJson(Data, Text);
+	const double JsonSave = FPlatformTime::Seconds() - Start;
+
+	Start = FPlatformTime::Seconds();
+	const bool bJsonOk = FLevelFile::LoadJson(Text, Loaded, Error);
+	const double JsonLoad = FPlatformTime::Seconds() - Start;
+
+	Start = FPlatformTime::Seconds();
+	TArray<uint8> Bytes;
+	FLevelFile::SaveBinary(Data, Bytes);
+	const double BinarySave = FPlatformTime::Seconds() - Start;
+
+	Start = FPlatformTime::Seconds();
+	const bool bBinaryOk = FLevelFile::LoadBinary(Bytes, Loaded, Error);
+	const double BinaryLoad = FPlatformTime::Seconds() - Start;
+
+	UE_LOG(LogTemp, Warning, TEXT("Level %dx%d with %d units: JSON %d chars, save %.2f ms, load %.2f ms%s"),
+		Size, Size, Data.Units.Num(), Text.Len(), JsonSave * 1000.0, JsonLoad * 1000.0, bJsonOk ? TEXT("") : TEXT(" (FAILED)"));
+	UE_LOG(LogTemp, Warning, TEXT("Binary %d bytes, save %.2f ms, load %.2f ms%s"),
+		Bytes.Num(), BinarySave * 1000.0, BinaryLoad * 1000.0, bBinaryOk ? TEXT("") : TEXT(" (FAILED)"));
+}
+
+static FAutoConsoleCommand BenchmarkLevelFileCommand(
+	TEXT("HW2.BenchmarkLevelFile"),
+	TEXT("Time saving and loading a random level in both formats. Args: [Size=256] [Units=4096] [Seed=1]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkLevelFile));
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridTypes.h"
+
+struct FLevelFileUnit
+{
+	// Path of the unit class, e.g. /Game/Units/BP_Knight.BP_Knight_C; resolved on the game thread
+	FString ClassPath;
+	FSGridPosition Position;
+};
+
+// Everything a level file holds. Plain data with no UObjects, so it can be read and parsed off the game thread.
+struct FLevelFileData
+{
+	int NumRows = 0;
+	int NumCols = 0;
+
+	// One EGridState per cell, row by row; empty means every cell starts in GS_Default
+	TArray<uint8> CellStates;
+
+	TArray<FLevelFileUnit> Units;
+};
+
+/**
+ * Reads and writes HW2 levels in two formats: JSON (.json), for hand editing and generating levels
+ * with outside tools, and a compact binary format (any other extension). The binary format stores cell
+ * states run-length encoded and each unit class path once, so a unit costs four bytes.
+ */
+class FLevelFile
+{
+public:
+	static void SaveJson(const FLevelFileData& Data, FString& OutText);
+	static bool LoadJson(const FString& Text, FLevelFileData& OutData, FString& OutError);
+
+	static void SaveBinary(const FLevelFileData& Data, TArray<uint8>& OutBytes);
+	static bool LoadBinary(const TArray<uint8>& Bytes, FLevelFileData& OutData, FString& OutError);
+
+	// Pick the format from the extension. Safe to call from any thread.
+	static bool SaveToFile(const FLevelFileData& Data, const FString& Path);
+	static bool LoadFromFile(const FString& Path, FLevelFileData& OutData, FString& OutError);
+
+	// Check dimensions and that units sit on distinct cells inside the grid
+	static bool Validate(const FLevelFileData& Data, FString& OutError);
+};
@@ -2,9 +2,8 @@
 
 
 #include "MoveCommand.h"
-#include "GameGrid.h"
 
-MoveCommand::MoveCommand(FSGridPosition Src, FSGridPosition Dst) : Source(Src), Destination(Dst)
+MoveCommand::MoveCommand(FBoardContext& InBoard, FSGridPosition Src, FSGridPosition Dst) : Board(InBoard), Source(Src), Destination(Dst)
 {
 
 }
@@ -15,31 +14,21 @@ MoveCommand::~MoveCommand()
 }
 
 void MoveCommand::Execute() {
-	UE_LOG(LogTemp, Warning, TEXT("Executing MoveCommand..."));
+	UE_LOG(LogTemp, Verbose, TEXT("Executing MoveCommand..."));
 
-	AGameSlot* SlotA = AGameGrid::FindSlot(Source);
-	AGameSlot* SlotB = AGameGrid::FindSlot(Destination);
+	check(Board.IsOccupied(Source));
 
-	AUnitBase* UnitA = SlotA->Unit;
-
-	check(UnitA);
-
-	UnitA->AssignToSlot(SlotB);
-    SlotA->SetState(GS_Default);
-	SlotB->SetState(GS_Highlighted);
+	Board.MoveUnit(Source, Destination);
+	Board.SetCellState(Source, GS_Default);
+	Board.SetCellState(Destination, GS_Highlighted);
 }
 
 void MoveCommand::Revert() {
-    UE_LOG(LogTemp, Warning, TEXT("Reverting MoveCommand..."));
-
-    AGameSlot* SlotA = AGameGrid::FindSlot(Source);
-    AGameSlot* SlotB = AGameGrid::FindSlot(Destination);
-
-    AUnitBase* UnitB = SlotB->Unit;
+    UE_LOG(LogTemp, Verbose, TEXT("Reverting MoveCommand..."));
 
-    check(UnitB);
+    check(Board.IsOccupied(Destination));
 
-    UnitB->AssignToSlot(SlotA);
-    SlotA->SetState(GS_Default);
-    SlotB->SetState(GS_Default);
+    Board.MoveUnit(Destination, Source);
+    Board.SetCellState(Source, GS_Default);
+    Board.SetCellState(Destination, GS_Default);
 }
\ No newline at end of file
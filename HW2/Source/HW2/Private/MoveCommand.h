@@ -4,7 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Command.h"
-#include "GameSlot.h"
+#include "BoardContext.h"
 
 /**
  * 
@@ -12,12 +12,13 @@
 class MoveCommand : public Command
 {
 public:
-	MoveCommand(FSGridPosition Src, FSGridPosition Dst);
+	MoveCommand(FBoardContext& InBoard, FSGridPosition Src, FSGridPosition Dst);
 	~MoveCommand();
 	virtual void Execute() override;
 	virtual void Revert() override;
 
 private:
+	FBoardContext& Board;
 	FSGridPosition Source, Destination;
 
 };
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SimBoard.h"
+#include "MoveCommand.h"
+#include "CommandHistory.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include <atomic>
+
+FSimBoard::FSimBoard(int InNumRows, int InNumCols) : NumRows(InNumRows), NumCols(InNumCols)
+{
+	Units.Init(0, NumRows * NumCols);
+	States.Init(GS_Default, NumRows * NumCols);
+}
+
+bool FSimBoard::PlaceUnit(const FSGridPosition& Position, int32 UnitId) {
+	check(UnitId > 0);
+	if (!IsValidPosition(Position) || IsOccupied(Position)) return false;
+
+	Units[ToIndex(Position)] = UnitId;
+	return true;
+}
+
+int32 FSimBoard::GetUnitAt(const FSGridPosition& Position) const {
+	return IsValidPosition(Position) ? Units[ToIndex(Position)] : 0;
+}
+
+bool FSimBoard::IsValidPosition(const FSGridPosition& Position) const {
+	return Position.Row < NumRows && Position.Col < NumCols;
+}
+
+bool FSimBoard::IsOccupied(const FSGridPosition& Position) const {
+	return GetUnitAt(Position) != 0;
+}
+
+void FSimBoard::MoveUnit(const FSGridPosition& Source, const FSGridPosition& Destination) {
+	check(IsOccupied(Source) && IsValidPosition(Destination) && !IsOccupied(Destination));
+
+	Units[ToIndex(Destination)] = Units[ToIndex(Source)];
+	Units[ToIndex(Source)] = 0;
+}
+
+EGridState FSimBoard::GetCellState(const FSGridPosition& Position) const {
+	return IsValidPosition(Position) ? static_cast<EGridState>(States[ToIndex(Position)]) : GS_Default;
+}
+
+void FSimBoard::SetCellState(const FSGridPosition& Position, EGridState NewState) {
+	if (IsValidPosition(Position)) States[ToIndex(Position)] = NewState;
+}
+
+bool FSimBoard::operator==(const FSimBoard& Other) const {
+	return NumRows == Other.NumRows && NumCols == Other.NumCols && Units == Other.Units && States == Other.States;
+}
+
+FSimBoardRunResult FSimBoard::SimulateRandomMoves(int NumBoards, int Size, int NumUnits, int NumMoves, int32 Seed) {
+	NumBoards = FMath::Max(1, NumBoards);
+	Size = FMath::Clamp(Size, 2, 256);
+	NumUnits = FMath::Clamp(NumUnits, 1, Size * Size - 1);
+	NumMoves = FMath::Max(1, NumMoves);
+
+	std::atomic<int32> Mismatches(0);
+	std::atomic<int64> Commands(0);
+
+	const double Start = FPlatformTime::Seconds();
+
+	ParallelFor(NumBoards, [&](int32 BoardIndex) {
+		FRandomStream Random(Seed + BoardIndex);
+
+		FSimBoard Board(Size, Size);
+		TArray<FSGridPosition> Positions;
+		while (Positions.Num() < NumUnits) {
+			FSGridPosition Position(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1));
+			if (Board.PlaceUnit(Position, Positions.Num() + 1)) Positions.Add(Position);
+		}
+
+		const FSimBoard Initial = Board;
+		FCommandHistory History(NumMoves);
+		int64 Applied = 0;
+
+		// One orthogonal step per move; blocked steps are skipped
+		for (int Move = 0; Move < NumMoves; Move++) {
+			const int32 Unit = Random.RandRange(0, NumUnits - 1);
+			const FSGridPosition Source = Positions[Unit];
+
+			const int Direction = Random.RandRange(0, 3);
+			const int Row = Source.Row + (Direction == 0 ? -1 : Direction == 1 ? 1 : 0);
+			const int Col = Source.Col + (Direction == 2 ? -1 : Direction == 3 ? 1 : 0);
+			if (Row < 0 || Row >= Size || Col < 0 || Col >= Size) continue;
+
+			const FSGridPosition Destination(Col, Row);
+			if (Board.IsOccupied(Destination)) continue;
+
+			MoveCommand(Board, Source, Destination).Execute();
+			History.Push({ ECommandType::Move, Source, Destination });
+			Positions[Unit] = Destination;
+			Applied++;
+		}
+
+		while (const FCommandRecord* Record = History.Undo()) {
+			MoveCommand(Board, Record->Source, Record->Destination).Revert();
+			Applied++;
+		}
+
+		if (!(Board == Initial)) Mismatches++;
+		Commands += Applied;
+	});
+
+	FSimBoardRunResult Result;
+	Result.Mismatches = Mismatches;
+	Result.Commands = Commands;
+	Result.Seconds = FPlatformTime::Seconds() - Start;
+	return Result;
+}
+
+// Usage: HW2.SimulateBoards [Boards=64] [Size=16] [Units=32] [Moves=2000] [Seed=1]
+// Timing run of SimulateRandomMoves; the HW2.SimBoard automation tests check the same thing for correctness
+static void SimulateBoards(const TArray<FString>& Args) {
+	const int NumBoards = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 64;
+	const int Size = FMath::Clamp(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 16, 2, 256);
+	const int NumUnits = FMath::Clamp(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 32, 1, Size * Size - 1);
+	const int NumMoves = Args.Num() > 3 ? FCString::Atoi(*Args[3]) : 2000;
+	const int32 Seed = Args.Num() > 4 ? FCString::Atoi(*Args[4]) : 1;
+
+	const FSimBoardRunResult Result = FSimBoard::SimulateRandomMoves(NumBoards, Size, NumUnits, NumMoves, Seed);
+
+	UE_LOG(LogTemp, Warning, TEXT("Simulated %d boards of %dx%d with %d units: %lld commands in %.2f ms (%.2fM commands/s), %d boards mismatched after undo"),
+		FMath::Max(1, NumBoards), Size, Size, NumUnits, Result.Commands, Result.Seconds * 1000.0, Result.Commands / FMath::Max(Result.Seconds, 1e-9) / 1e6, Result.Mismatches);
+}
+
+static FAutoConsoleCommand SimulateBoardsCommand(
+	TEXT("HW2.SimulateBoards"),
+	TEXT("Run random moves and a full undo on many independent boards in parallel and check they all end where they started. Args: [Boards=64] [Size=16] [Units=32] [Moves=2000] [Seed=1]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&SimulateBoards));
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BoardContext.h"
+
+// Outcome of FSimBoard::SimulateRandomMoves
+struct FSimBoardRunResult
+{
+	// Boards that did not end where they started
+	int32 Mismatches = 0;
+
+	// Moves executed plus moves reverted, over all boards
+	int64 Commands = 0;
+
+	double Seconds = 0.0;
+};
+
+/**
+ * Board without actors: units are plain ids in a flat array. Each instance is independent, so one
+ * per worker can run commands in parallel, e.g. to play out games or check commands in bulk.
+ */
+class FSimBoard : public FBoardContext
+{
+public:
+	FSimBoard(int InNumRows, int InNumCols);
+
+	// Put a new unit on a free cell; ids start at 1, 0 marks an empty cell
+	bool PlaceUnit(const FSGridPosition& Position, int32 UnitId);
+	int32 GetUnitAt(const FSGridPosition& Position) const;
+
+	virtual bool IsValidPosition(const FSGridPosition& Position) const override;
+	virtual bool IsOccupied(const FSGridPosition& Position) const override;
+	virtual void MoveUnit(const FSGridPosition& Source, const FSGridPosition& Destination) override;
+	virtual EGridState GetCellState(const FSGridPosition& Position) const override;
+	virtual void SetCellState(const FSGridPosition& Position, EGridState NewState) override;
+
+	int GetNumRows() const { return NumRows; }
+	int GetNumCols() const { return NumCols; }
+
+	bool operator==(const FSimBoard& Other) const;
+
+	// Play NumMoves random one-cell moves on each of NumBoards independent boards in parallel, then undo
+	// them all through an FCommandHistory. Every board should end exactly where it started
+	static FSimBoardRunResult SimulateRandomMoves(int NumBoards, int Size, int NumUnits, int NumMoves, int32 Seed);
+
+private:
+	int32 ToIndex(const FSGridPosition& Position) const { return Position.Row * NumCols + Position.Col; }
+
+	int NumRows;
+	int NumCols;
+	TArray<int32> Units;
+	TArray<uint8> States;
+};
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SimBoard.h"
+#include "GameGrid.h"
+#include "UnitBase.h"
+#include "MoveCommand.h"
+#include "CommandHistory.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSimBoardUndoTest, "HW2.SimBoard.UndoRestoresBoards", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSimBoardUndoTest::RunTest(const FString& Parameters) {
+	struct FCase { int Boards; int Size; int Units; int Moves; };
+
+	// Defaults of HW2.SimulateBoards, a board with one free cell, the smallest board, and a long run on a big board
+	const FCase Cases[] = {
+		{ 64, 16, 32, 2000 },
+		{ 8, 8, 63, 2000 },
+		{ 16, 2, 1, 500 },
+		{ 4, 32, 200, 20000 },
+	};
+
+	for (const FCase& Case : Cases) {
+		const FSimBoardRunResult Result = FSimBoard::SimulateRandomMoves(Case.Boards, Case.Size, Case.Units, Case.Moves, 1);
+		const FString What = FString::Printf(TEXT("%d boards of %dx%d, %d units, %d moves"), Case.Boards, Case.Size, Case.Size, Case.Units, Case.Moves);
+
+		TestEqual(*FString::Printf(TEXT("Mismatched boards after undo (%s)"), *What), Result.Mismatches, 0);
+		TestTrue(*FString::Printf(TEXT("Commands ran (%s)"), *What), Result.Commands > 0);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameGridMoveCommandTest, "HW2.SimBoard.GameGridMatchesSimBoard", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGameGridMoveCommandTest::RunTest(const FString& Parameters) {
+	const int Size = 6;
+	const int NumUnits = 8;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	Context.SetCurrentWorld(World);
+
+	// Flat store, so the grid needs no slot class; it has to be set before the cells are built
+	AGameGrid* Grid = World->SpawnActorDeferred<AGameGrid>(AGameGrid::StaticClass(), FTransform::Identity);
+	Grid->bUseFlatStore = true;
+	Grid->NumRows = Size;
+	Grid->NumCols = Size;
+	Grid->FinishSpawning(FTransform::Identity);
+
+	// The same moves run on a sim board alongside, which the grid has to match after every command
+	FSimBoard Mirror(Size, Size);
+	FRandomStream Random(7);
+	TArray<AUnitBase*> Units;
+	TArray<FSGridPosition> Positions;
+	while (Units.Num() < NumUnits) {
+		FSGridPosition Position(Random.RandRange(0, Size - 1), Random.RandRange(0, Size - 1));
+		if (Mirror.IsOccupied(Position)) continue;
+
+		AUnitBase* Unit = Grid->SpawnUnitAt(AUnitBase::StaticClass(), Position);
+		if (!TestNotNull(TEXT("Unit spawned"), Unit)) break;
+
+		Mirror.PlaceUnit(Position, Units.Num() + 1);
+		Units.Add(Unit);
+		Positions.Add(Position);
+	}
+
+	const FSimBoard Initial = Mirror;
+
+	auto BoardsMatch = [&]() {
+		for (int Row = 0; Row < Size; Row++) {
+			for (int Col = 0; Col < Size; Col++) {
+				const FSGridPosition Position(Col, Row);
+				const int32 UnitId = Mirror.GetUnitAt(Position);
+				const AUnitBase* Expected = UnitId > 0 ? Units[UnitId - 1] : nullptr;
+
+				if (Grid->GetUnitAt(Position) != Expected || Grid->GetCellState(Position) != Mirror.GetCellState(Position)) {
+					AddError(FString::Printf(TEXT("Grid and sim board differ at row %d, column %d"), Row, Col));
+					return false;
+				}
+				if (Expected && (Expected->GridPosition.Row != Row || Expected->GridPosition.Col != Col)) {
+					AddError(FString::Printf(TEXT("Unit on row %d, column %d thinks it is elsewhere"), Row, Col));
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	FCommandHistory History(256);
+	bool bMatched = Units.Num() == NumUnits && BoardsMatch();
+
+	for (int Move = 0; Move < 200 && bMatched; Move++) {
+		const int32 Unit = Random.RandRange(0, NumUnits - 1);
+		const FSGridPosition Source = Positions[Unit];
+
+		const int Direction = Random.RandRange(0, 3);
+		const int Row = Source.Row + (Direction == 0 ? -1 : Direction == 1 ? 1 : 0);
+		const int Col = Source.Col + (Direction == 2 ? -1 : Direction == 3 ? 1 : 0);
+		if (Row < 0 || Row >= Size || Col < 0 || Col >= Size) continue;
+
+		const FSGridPosition Destination(Col, Row);
+		if (Mirror.IsOccupied(Destination)) continue;
+
+		MoveCommand(*Grid, Source, Destination).Execute();
+		MoveCommand(Mirror, Source, Destination).Execute();
+		History.Push({ ECommandType::Move, Source, Destination });
+		Positions[Unit] = Destination;
+
+		bMatched = BoardsMatch();
+		if (bMatched) {
+			TestEqual(TEXT("Unit actor follows its cell"), Units[Unit]->GetActorLocation(), Grid->GetCellLocation(Destination) + Units[Unit]->StartOffset);
+		}
+	}
+
+	while (const FCommandRecord* Record = bMatched ? History.Undo() : nullptr) {
+		MoveCommand(*Grid, Record->Source, Record->Destination).Revert();
+		MoveCommand(Mirror, Record->Source, Record->Destination).Revert();
+		bMatched = BoardsMatch();
+	}
+
+	TestTrue(TEXT("Undo puts every unit back"), bMatched && Mirror == Initial);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+#endif
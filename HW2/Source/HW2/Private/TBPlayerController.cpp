@@ -13,6 +13,10 @@ void ATBPlayerController::SetupInputComponent()
     Super::SetupInputComponent();
 
     InputComponent->BindKey(EKeys::BackSpace, IE_Pressed, this, &ATBPlayerController::HandleUndoInput);
+    InputComponent->BindKey(FInputChord(EKeys::BackSpace, true, false, false, false), IE_Pressed, this, &ATBPlayerController::HandleRedoInput);
+    InputComponent->BindKey(FInputChord(EKeys::BackSpace, false, true, false, false), IE_Pressed, this, &ATBPlayerController::HandleCheckpointInput);
+    InputComponent->BindKey(EKeys::LeftMouseButton, IE_Pressed, this, &ATBPlayerController::HandleGridClick);
+    InputComponent->BindKey(EKeys::RightMouseButton, IE_Pressed, this, &ATBPlayerController::HandleGridClick);
 }
 
 void ATBPlayerController::BeginPlay() {
@@ -65,4 +69,48 @@ void ATBPlayerController::HandleUndoInput()
             GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Yellow, TEXT("NO MOVES LEFT"));
         }
     }
+}
+
+void ATBPlayerController::HandleRedoInput()
+{
+    if (GameManager)
+    {
+        if (GameManager->RedoMove())
+        {
+            GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Green, TEXT("REDONE"));
+        }
+        else
+        {
+            GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Yellow, TEXT("NOTHING TO REDO"));
+        }
+    }
+}
+
+void ATBPlayerController::HandleCheckpointInput()
+{
+    if (GameManager)
+    {
+        if (GameManager->RevertToCheckpoint())
+        {
+            GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Green, TEXT("REVERTED TO CHECKPOINT"));
+        }
+        else
+        {
+            GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::Yellow, TEXT("NO EARLIER CHECKPOINT"));
+        }
+    }
+}
+
+void ATBPlayerController::HandleGridClick(FKey Key)
+{
+    // Slot actors report their own clicks through OnActorClicked
+    if (!GameManager || !GameManager->GameGrid || !GameManager->GameGrid->bUseFlatStore) return;
+
+    FVector Origin, Direction;
+    if (!DeprojectMousePositionToWorld(Origin, Direction)) return;
+
+    FSGridPosition Position;
+    if (GameManager->GameGrid->GetCellFromRay(Origin, Direction, Position)) {
+        GameManager->OnCellClicked(Position, Key);
+    }
 }
\ No newline at end of file
@@ -30,4 +30,9 @@ public:
 	AGameManager* GameManager;
 
 	void HandleUndoInput();
+	void HandleRedoInput();
+	void HandleCheckpointInput();
+
+	// Flat store grids have no slot actors to click, so mouse presses are resolved to a cell here
+	void HandleGridClick(FKey Key);
 };
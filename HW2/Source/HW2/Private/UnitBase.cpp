@@ -3,6 +3,7 @@
 
 #include "UnitBase.h"
 #include "GameSlot.h"
+#include "GameGrid.h"
 
 // Sets default values
 AUnitBase::AUnitBase()
@@ -27,11 +28,24 @@ void AUnitBase::Tick(float DeltaTime)
 }
 
 void AUnitBase::AssignToSlot(AGameSlot* NewSlot) {
-	check(NewSlot && NewSlot->Unit == nullptr);
+	check(NewSlot && NewSlot->Grid && NewSlot->Unit == nullptr);
 
-	if (Slot) Slot->Unit = nullptr;
-	Slot = NewSlot;
-	Slot->Unit = this;
-	SetActorLocation(Slot->GetActorLocation() + StartOffset);
+	AssignToCell(NewSlot->Grid, NewSlot->GridPosition);
 }
 
+void AUnitBase::AssignToCell(AGameGrid* NewGrid, const FSGridPosition& Position) {
+	check(NewGrid && NewGrid->GetUnitAt(Position) == nullptr);
+
+	if (Grid) Grid->SetUnitAt(GridPosition, nullptr);
+	Grid = NewGrid;
+	GridPosition = Position;
+	Grid->SetUnitAt(GridPosition, this);
+	Slot = Grid->GetSlot(GridPosition);
+	SetActorLocation(Grid->GetCellLocation(GridPosition) + StartOffset);
+}
+
+void AUnitBase::LeaveCell() {
+	if (Grid) Grid->SetUnitAt(GridPosition, nullptr);
+	Grid = nullptr;
+	Slot = nullptr;
+}
@@ -4,9 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GridTypes.h"
 #include "UnitBase.generated.h"
 
 class AGameSlot;
+class AGameGrid;
 
 UCLASS()
 class AUnitBase : public AActor
@@ -19,15 +21,28 @@ public:
 
 	void AssignToSlot(AGameSlot* NewSlot);
 
+	// Move onto a cell of the grid, freeing the one the unit was on; works with or without slot actors
+	void AssignToCell(AGameGrid* NewGrid, const FSGridPosition& Position);
+
+	// Free the cell the unit is on without placing it anywhere
+	void LeaveCell();
+
 	UFUNCTION(BlueprintImplementableEvent, BlueprintPure)
 	bool IsControlledByThePlayer();
 
 	UPROPERTY(EditAnywhere)
 	FVector StartOffset;
 
+	// Only set when the grid spawns slot actors
 	UPROPERTY(VisibleAnywhere)
 	AGameSlot* Slot;
 
+	UPROPERTY(VisibleAnywhere)
+	AGameGrid* Grid;
+
+	UPROPERTY(VisibleAnywhere)
+	FSGridPosition GridPosition;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -2,9 +2,10 @@
 
 
 #include "TileBase.h"
+#include "TileMap.h"
 
 // Sets default values
-ATileBase::ATileBase()
+ATileBase::ATileBase() : CullDistance(0.0f), bHasCollision(true)
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -26,6 +27,124 @@ void ATileBase::OnConstruction(const FTransform& Transform) {
 	InstancedMesh->SetStaticMesh(BaseMesh);
 }
 
+FTileChunkMesh& ATileBase::FindOrAddChunkMesh(const FIntPoint& ChunkCoord)
+{
+	FTileChunkMesh& Chunk = ChunkMeshes.FindOrAdd(ChunkCoord);
+	if (Chunk.Mesh) return Chunk;
+
+	Chunk.Mesh = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+	Chunk.Mesh->SetStaticMesh(InstancedMesh->GetStaticMesh());
+	for (int32 i = 0; i < InstancedMesh->GetNumMaterials(); i++)
+	{
+		Chunk.Mesh->SetMaterial(i, InstancedMesh->GetMaterial(i));
+	}
+	Chunk.Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Chunk.Mesh->SetCullDistances(0, CullDistance);
+	Chunk.Mesh->SetupAttachment(RootComponent);
+	Chunk.Mesh->RegisterComponent();
+
+	return Chunk;
+}
+
+int32 ATileBase::AddTileInstance(const FTransform& Transform, const FIntPoint& Cell)
+{
+	FTileChunkMesh& Chunk = FindOrAddChunkMesh(FTileMap::GetChunkCoord(Cell));
+
+	int32 Index = Chunk.Mesh->AddInstance(Transform, true);
+	check(Index == Chunk.InstanceCells.Num());
+
+	Chunk.InstanceCells.Add(Cell);
+	return Index;
+}
+
+int32 ATileBase::AddTileInstances(const FIntPoint& ChunkCoord, const TArray<FTransform>& Transforms, const TArray<FIntPoint>& Cells)
+{
+	check(Transforms.Num() == Cells.Num());
+
+	FTileChunkMesh& Chunk = FindOrAddChunkMesh(ChunkCoord);
+	const int32 FirstIndex = Chunk.InstanceCells.Num();
+
+	// One buffer update and one tree build for the whole batch
+	Chunk.Mesh->AddInstances(Transforms, false, true);
+	Chunk.InstanceCells.Append(Cells);
+	check(Chunk.Mesh->GetInstanceCount() == Chunk.InstanceCells.Num());
+
+	return FirstIndex;
+}
+
+FTransform ATileBase::GetTileInstanceTransform(const FIntPoint& Cell, int32 Index) const
+{
+	const FTileChunkMesh* Chunk = ChunkMeshes.Find(FTileMap::GetChunkCoord(Cell));
+	check(Chunk && Chunk->InstanceCells.IsValidIndex(Index));
+
+	FTransform Transform;
+	Chunk->Mesh->GetInstanceTransform(Index, Transform, true);
+	return Transform;
+}
+
+void ATileBase::UpdateTileInstances(const TArray<FIntPoint>& Cells, const TArray<int32>& Indices, const TArray<FTransform>& Transforms)
+{
+	check(Cells.Num() == Indices.Num() && Cells.Num() == Transforms.Num());
+
+	TSet<UHierarchicalInstancedStaticMeshComponent*> Touched;
+	for (int32 i = 0; i < Cells.Num(); i++)
+	{
+		FTileChunkMesh* Chunk = ChunkMeshes.Find(FTileMap::GetChunkCoord(Cells[i]));
+		check(Chunk && Chunk->InstanceCells.IsValidIndex(Indices[i]) && Chunk->InstanceCells[Indices[i]] == Cells[i]);
+
+		Chunk->Mesh->UpdateInstanceTransform(Indices[i], Transforms[i], true, false, true);
+		Touched.Add(Chunk->Mesh);
+	}
+
+	for (UHierarchicalInstancedStaticMeshComponent* Mesh : Touched)
+	{
+		Mesh->MarkRenderStateDirty();
+	}
+}
+
+void ATileBase::ClearTileInstances()
+{
+	for (auto& Pair : ChunkMeshes)
+	{
+		if (Pair.Value.Mesh) Pair.Value.Mesh->DestroyComponent();
+	}
+	ChunkMeshes.Reset();
+}
+
+bool ATileBase::RemoveTileInstance(const FIntPoint& Cell, int32 Index, FIntPoint& OutMovedCell)
+{
+	const FIntPoint ChunkCoord = FTileMap::GetChunkCoord(Cell);
+	FTileChunkMesh* Chunk = ChunkMeshes.Find(ChunkCoord);
+	check(Chunk && Chunk->InstanceCells.IsValidIndex(Index));
+
+	// An emptied chunk gives its component back
+	if (Chunk->InstanceCells.Num() == 1)
+	{
+		Chunk->Mesh->DestroyComponent();
+		ChunkMeshes.Remove(ChunkCoord);
+		return false;
+	}
+
+	const int32 LastIndex = Chunk->InstanceCells.Num() - 1;
+	bool bMoved = false;
+
+	// Removing the last instance is O(1); any other index would shift every instance after it
+	if (Index != LastIndex)
+	{
+		FTransform LastTransform;
+		Chunk->Mesh->GetInstanceTransform(LastIndex, LastTransform, false);
+		Chunk->Mesh->UpdateInstanceTransform(Index, LastTransform, false, false, true);
+
+		Chunk->InstanceCells[Index] = Chunk->InstanceCells[LastIndex];
+		OutMovedCell = Chunk->InstanceCells[Index];
+		bMoved = true;
+	}
+
+	Chunk->Mesh->RemoveInstance(LastIndex);
+	Chunk->InstanceCells.Pop(EAllowShrinking::No);
+	return bMoved;
+}
+
 // Called when the game starts or when spawned
 void ATileBase::BeginPlay()
 {
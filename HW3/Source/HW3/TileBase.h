@@ -5,8 +5,22 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Components/InstancedStaticMeshComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "TileBase.generated.h"
 
+// The instances of one tile type inside one map chunk
+USTRUCT()
+struct FTileChunkMesh
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UHierarchicalInstancedStaticMeshComponent* Mesh = nullptr;
+
+	// Cell of every instance, by instance index
+	TArray<FIntPoint> InstanceCells;
+};
+
 UCLASS()
 class HW3_API ATileBase : public AActor
 {
@@ -19,11 +33,50 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	UStaticMesh* BaseMesh;
 
+	// Template for the chunk meshes: its mesh, materials and relative transform apply to every placed tile.
+	// It holds no instances itself.
 	UPROPERTY(EditAnywhere)
 	UInstancedStaticMeshComponent* InstancedMesh;
 
+	// Distance beyond which a chunk's tiles are culled; 0 never culls
+	UPROPERTY(EditAnywhere)
+	float CullDistance;
+
+	// Whether placed tiles of this type block, when the map generates collision
+	UPROPERTY(EditAnywhere)
+	bool bHasCollision;
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	// Add an instance for a tile on Cell to the mesh of Cell's chunk; returns its index within that chunk
+	int32 AddTileInstance(const FTransform& Transform, const FIntPoint& Cell);
+
+	// Remove an instance from Cell's chunk by moving the chunk's last instance into its index, so nothing else
+	// shifts. Returns true and the cell of the moved instance if one moved; that cell's instance index is now Index.
+	bool RemoveTileInstance(const FIntPoint& Cell, int32 Index, FIntPoint& OutMovedCell);
+
+	// Add many instances to one chunk in a single call, e.g. when loading; returns the index of the first
+	int32 AddTileInstances(const FIntPoint& ChunkCoord, const TArray<FTransform>& Transforms, const TArray<FIntPoint>& Cells);
+
+	// World transform of the instance at Index in Cell's chunk
+	FTransform GetTileInstanceTransform(const FIntPoint& Cell, int32 Index) const;
+
+	// Move instances already placed, Indices[i] being the instance of Cells[i], with one render update per chunk touched
+	void UpdateTileInstances(const TArray<FIntPoint>& Cells, const TArray<int32>& Indices, const TArray<FTransform>& Transforms);
+
+	// Remove every placed instance along with the chunk meshes
+	void ClearTileInstances();
+
+	int32 NumChunkMeshes() const { return ChunkMeshes.Num(); }
+
+private:
+	FTileChunkMesh& FindOrAddChunkMesh(const FIntPoint& ChunkCoord);
+
+	// One mesh per map chunk that has tiles of this type, so an edit only rebuilds that chunk's tree
+	// and each chunk is culled on its own bounds
+	UPROPERTY()
+	TMap<FIntPoint, FTileChunkMesh> ChunkMeshes;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileChunkCollisionComponent.h"
+#include "TileMap.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Engine/CollisionProfile.h"
+
+UTileChunkCollisionComponent::UTileChunkCollisionComponent() : BodySetup(nullptr), Bounds(ForceInit)
+{
+	SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	SetUsingAbsoluteLocation(true);
+	SetUsingAbsoluteRotation(true);
+	SetUsingAbsoluteScale(true);
+	SetGenerateOverlapEvents(false);
+	bHiddenInGame = true;
+}
+
+void UTileChunkCollisionComponent::SetBoxes(const TArray<FBox>& Boxes)
+{
+	// A fresh body setup each time; the old one may still be referenced by the physics scene until it's recreated
+	BodySetup = NewObject<UBodySetup>(this, NAME_None, RF_Transient);
+	BodySetup->BodySetupGuid = FGuid::NewGuid();
+	BodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+	BodySetup->bGenerateMirroredCollision = false;
+
+	Bounds.Init();
+	for (const FBox& Box : Boxes)
+	{
+		const FVector Size = Box.GetSize();
+		FKBoxElem Element(Size.X, Size.Y, Size.Z);
+		Element.Center = Box.GetCenter();
+		BodySetup->AggGeom.BoxElems.Add(Element);
+		Bounds += Box;
+	}
+	BodySetup->CreatePhysicsMeshes();
+
+	RecreatePhysicsState();
+	UpdateBounds();
+}
+
+int32 UTileChunkCollisionComponent::NumBoxes() const
+{
+	return BodySetup ? BodySetup->AggGeom.BoxElems.Num() : 0;
+}
+
+FBoxSphereBounds UTileChunkCollisionComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	return Bounds.IsValid ? FBoxSphereBounds(Bounds.TransformBy(LocalToWorld)) : FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0f);
+}
+
+static bool AreBoxesEqualOnAxis(const FBox& A, const FBox& B, int32 Axis)
+{
+	return FMath::IsNearlyEqual(A.Min[Axis], B.Min[Axis], 0.01) && FMath::IsNearlyEqual(A.Max[Axis], B.Max[Axis], 0.01);
+}
+
+void UTileChunkCollisionComponent::MergeCellBoxes(const TArray<FBox>& CellBoxes, TArray<FBox>& OutBoxes)
+{
+	check(CellBoxes.Num() == FTileMap::ChunkSize * FTileMap::ChunkSize);
+
+	// Boxes reaching the row before, which the current row may extend
+	TArray<FBox> Open;
+	TArray<FBox> Row;
+	TArray<FBox> NextOpen;
+
+	for (int32 Y = 0; Y < FTileMap::ChunkSize; Y++)
+	{
+		Row.Reset();
+		for (int32 X = 0; X < FTileMap::ChunkSize; X++)
+		{
+			const FBox& Box = CellBoxes[(Y << FTileMap::ChunkShift) | X];
+			if (!Box.IsValid) continue;
+
+			// Join the previous box in this row if it ends where this one starts and covers the same span otherwise
+			if (Row.Num() > 0 && FMath::IsNearlyEqual(Row.Last().Max.X, Box.Min.X, 0.01)
+				&& AreBoxesEqualOnAxis(Row.Last(), Box, 1) && AreBoxesEqualOnAxis(Row.Last(), Box, 2))
+			{
+				Row.Last().Max.X = Box.Max.X;
+			}
+			else
+			{
+				Row.Add(Box);
+			}
+		}
+
+		NextOpen.Reset();
+		for (const FBox& RowBox : Row)
+		{
+			const int32 Below = Open.IndexOfByPredicate([&RowBox](const FBox& OpenBox)
+			{
+				return FMath::IsNearlyEqual(OpenBox.Max.Y, RowBox.Min.Y, 0.01) && AreBoxesEqualOnAxis(OpenBox, RowBox, 0) && AreBoxesEqualOnAxis(OpenBox, RowBox, 2);
+			});
+
+			if (Below != INDEX_NONE)
+			{
+				FBox Grown = Open[Below];
+				Grown.Max.Y = RowBox.Max.Y;
+				NextOpen.Add(Grown);
+				Open.RemoveAtSwap(Below, 1, EAllowShrinking::No);
+			}
+			else
+			{
+				NextOpen.Add(RowBox);
+			}
+		}
+
+		// Whatever the row didn't extend is finished
+		OutBoxes.Append(Open);
+		Swap(Open, NextOpen);
+	}
+
+	OutBoxes.Append(Open);
+}
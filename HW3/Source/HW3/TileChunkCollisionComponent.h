@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/PrimitiveComponent.h"
+#include "TileChunkCollisionComponent.generated.h"
+
+class UBodySetup;
+
+/**
+ * Collision for every tile in one map chunk as a single body made of boxes, so a chunk costs one physics
+ * body however many tiles it holds. Boxes are in world space; the component stays at the world origin.
+ */
+UCLASS()
+class HW3_API UTileChunkCollisionComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTileChunkCollisionComponent();
+
+	// Replace the collision with these boxes and rebuild the physics state
+	void SetBoxes(const TArray<FBox>& Boxes);
+
+	int32 NumBoxes() const;
+
+	// Merge the boxes of a chunk's cells, given row by row with invalid boxes for empty cells. Boxes that line up
+	// along a row become one, then row boxes that line up with one in the next row grow into it.
+	static void MergeCellBoxes(const TArray<FBox>& CellBoxes, TArray<FBox>& OutBoxes);
+
+	virtual UBodySetup* GetBodySetup() override { return BodySetup; }
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	UPROPERTY(Transient)
+	UBodySetup* BodySetup;
+
+	FBox Bounds;
+};
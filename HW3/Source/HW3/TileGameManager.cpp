@@ -3,10 +3,18 @@
 
 #include "TileGameManager.h"
 #include "TilePlayerController.h"
-#include "GameFramework/PlayerInput.h"
+#include "TileMapGenerator.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
 
 // Sets default values
-ATileGameManager::ATileGameManager() : GridSize(100), GridOffset(0,0,0.5f), MapExtendInGrids(25), CurrentRotation(0.0f)
+ATileGameManager::ATileGameManager() : GridSize(100), GridOffset(0,0,0.5f), BuildPlaneHeight(0.0f), MapExtendInGrids(0), CurrentTileIndex(0), CurrentRotation(0.0f),
+	CursorCell(0, 0), bHasCursor(false), PlacementTool(ETilePlacementTool::Single), MaxFillCells(65536), bAutoTile(false), UndoDepth(256),
+	bGenerateCollision(false), CommitBudgetMs(4.0f), PendingStartTime(0), NextCommitBatch(INDEX_NONE), CommitSeconds(0),
+	CollisionGeneration(0), PendingCollisionGeneration(0), PlacementStart(0, 0), bPlacing(false)
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -39,6 +47,13 @@ void ATileGameManager::BeginPlay()
 		PlayerController->GameManager = this;
 	}
 
+    // Auto-tiling needs a valid tile type for every variant
+    if (bAutoTile && (AutoTileVariants.Num() != 6 || AutoTileVariants.ContainsByPredicate([this](int32 TileType) { return !TileTypes.IsValidIndex(TileType) || !TileTypes[TileType]; })))
+    {
+        UE_LOG(LogTemp, Error, TEXT("AutoTileVariants needs 6 valid tile type indices, auto-tiling is off"));
+        bAutoTile = false;
+    }
+
     UpdateTilePreview();
 }
 
@@ -46,56 +61,851 @@ void ATileGameManager::BeginPlay()
 void ATileGameManager::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+
+	if (PendingSave.IsValid() && PendingSave.IsReady())
+	{
+		const bool bSaved = PendingSave.Consume();
+		UE_LOG(LogTemp, Warning, TEXT("%s tile map %s in %.1f ms"), bSaved ? TEXT("Saved") : TEXT("Failed to save"),
+			*PendingPath, (FPlatformTime::Seconds() - PendingStartTime) * 1000.0);
+	}
+
+	if (PendingLoad.IsValid() && PendingLoad.IsReady())
+	{
+		ApplyLoadedTileMap(PendingLoad.Consume());
+	}
+	else if (NextCommitBatch != INDEX_NONE)
+	{
+		CommitLoadedBatches();
+	}
+
+	if (bGenerateCollision || PendingCollision.IsValid())
+	{
+		UpdateCollision();
+	}
 }
 
-void ATileGameManager::OnActorInteraction(AActor* HitActor, FVector& Location, bool IsPressed)
+bool ATileGameManager::SetCursorLocation(const FVector& Location)
 {
-    if (TileTypes.Num() == 0) return;
-
     FVector GridLoc = GridOffset;
     GridLoc.X += FMath::GridSnap(Location.X, GridSize);
     GridLoc.Y += FMath::GridSnap(Location.Y, GridSize);
-    GridLoc.Z = Location.Z;
+    GridLoc.Z = BuildPlaneHeight;
 
-    UPlayerInput* Input = GWorld->GetFirstPlayerController()->PlayerInput;
+    const FIntPoint Cell = WorldToCell(GridLoc);
+    if (bHasCursor && Cell == CursorCell) return false;
 
+    CursorCell = Cell;
+    bHasCursor = true;
     GridSelection->SetWorldLocation(GridLoc + GridOffset);
+    return true;
+}
+
+// Cells from A to B, one per step along the longer axis
+static void GetLineCells(const FIntPoint& A, const FIntPoint& B, TArray<FIntPoint>& OutCells)
+{
+    const FIntPoint Delta = B - A;
+    const int32 Steps = FMath::Max(FMath::Abs(Delta.X), FMath::Abs(Delta.Y));
+
+    OutCells.Reserve(Steps + 1);
+    for (int32 Step = 0; Step <= Steps; Step++)
+    {
+        const float Alpha = Steps > 0 ? (float)Step / Steps : 0.0f;
+        OutCells.Add(FIntPoint(A.X + FMath::RoundToInt(Delta.X * Alpha), A.Y + FMath::RoundToInt(Delta.Y * Alpha)));
+    }
+}
+
+static void GetRectangleCells(const FIntPoint& A, const FIntPoint& B, TArray<FIntPoint>& OutCells)
+{
+    const FIntPoint Min = A.ComponentMin(B);
+    const FIntPoint Max = A.ComponentMax(B);
+
+    OutCells.Reserve((Max.X - Min.X + 1) * (Max.Y - Min.Y + 1));
+    for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+    {
+        for (int32 X = Min.X; X <= Max.X; X++)
+        {
+            OutCells.Add(FIntPoint(X, Y));
+        }
+    }
+}
+
+void ATileGameManager::BeginPlacement()
+{
+    if (!bHasCursor || TileTypes.Num() == 0 || IsLoadingTileMap()) return;
+
+    const uint8 Rotation = FMath::RoundToInt(CurrentRotation / 90.0f) & 3;
+
+    switch (PlacementTool)
+    {
+    case ETilePlacementTool::Single:
+        if (IsCellInBounds(CursorCell)) PlaceTile(CursorCell, CurrentTileIndex, Rotation);
+        break;
+
+    case ETilePlacementTool::FloodFill:
+    {
+        TArray<FIntPoint> Cells;
+        if (!IsCellInBounds(CursorCell)) break;
+
+        if (GetFloodFillCells(CursorCell, Cells))
+        {
+            PlaceTiles(Cells, CurrentTileIndex, Rotation);
+        }
+        else
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Flood fill from (%d, %d) reaches more than %d cells, ignoring"), CursorCell.X, CursorCell.Y, MaxFillCells);
+        }
+        break;
+    }
+
+    default:
+        PlacementStart = CursorCell;
+        bPlacing = true;
+        break;
+    }
+}
+
+void ATileGameManager::EndPlacement()
+{
+    if (!bPlacing) return;
+    bPlacing = false;
+
+    if (TileTypes.Num() == 0 || IsLoadingTileMap()) return;
+
+    TArray<FIntPoint> Cells;
+    if (PlacementTool == ETilePlacementTool::Rectangle)
+    {
+        GetRectangleCells(PlacementStart, CursorCell, Cells);
+    }
+    else if (PlacementTool == ETilePlacementTool::Line)
+    {
+        GetLineCells(PlacementStart, CursorCell, Cells);
+    }
+
+    Cells.RemoveAllSwap([this](const FIntPoint& Cell) { return !IsCellInBounds(Cell); });
+    PlaceTiles(Cells, CurrentTileIndex, FMath::RoundToInt(CurrentRotation / 90.0f) & 3);
+}
+
+void ATileGameManager::EraseTileAtCursor()
+{
+    if (!bHasCursor || IsLoadingTileMap()) return;
+
+    EraseTile(CursorCell);
+}
+
+void ATileGameManager::SelectNextPlacementTool()
+{
+    bPlacing = false;
+    PlacementTool = (ETilePlacementTool)(((uint8)PlacementTool + 1) % ((uint8)ETilePlacementTool::FloodFill + 1));
+
+    UE_LOG(LogTemp, Warning, TEXT("Placement tool: %s"), *UEnum::GetValueAsString(PlacementTool));
+}
+
+void ATileGameManager::SelectTileType(int32 Offset)
+{
+    if (TileTypes.Num() == 0) return;
+
+    CurrentTileIndex = ((CurrentTileIndex + Offset) % TileTypes.Num() + TileTypes.Num()) % TileTypes.Num();
+    UpdateTilePreview();
+}
+
+void ATileGameManager::RotateCurrentTile()
+{
+    CurrentRotation += 90.0f;
+    if (CurrentRotation >= 360.0f)
+        CurrentRotation = 0.0f;
+    UpdateTilePreview();
+}
+
+bool ATileGameManager::PlaceTile(const FIntPoint& Cell, int32 TileType, uint8 Rotation, bool bRecordUndo)
+{
+    return PlaceTiles({ Cell }, TileType, Rotation, bRecordUndo) > 0;
+}
+
+bool ATileGameManager::EraseTile(const FIntPoint& Cell, bool bRecordUndo)
+{
+    return EditTiles({ Cell }, { FTileCell() }, bRecordUndo) > 0;
+}
+
+int32 ATileGameManager::PlaceTiles(const TArray<FIntPoint>& Cells, int32 TileType, uint8 Rotation, bool bRecordUndo)
+{
+    if (!TileTypes.IsValidIndex(TileType) || !TileTypes[TileType]) return 0;
+
+    FTileCell Tile;
+    Tile.TileType = TileType;
+    Tile.Rotation = Rotation;
+
+    TArray<FTileCell> Tiles;
+    Tiles.Init(Tile, Cells.Num());
+    return EditTiles(Cells, Tiles, bRecordUndo);
+}
+
+int32 ATileGameManager::EditTiles(const TArray<FIntPoint>& Cells, const TArray<FTileCell>& Tiles, bool bRecordUndo)
+{
+    if (bRecordUndo) BeginUndoGroup();
+
+    const int32 NumChanged = SetTiles(Cells, Tiles, bRecordUndo);
+    if (NumChanged > 0 && bAutoTile) UpdateAutoTiles(Cells, bRecordUndo);
+
+    if (bRecordUndo) EndUndoGroup();
+    if (NumChanged > 0) InvalidateCursor();
+    return NumChanged;
+}
+
+bool ATileGameManager::UndoLastEdit()
+{
+    if (UndoGroups.Num() == 0 || IsLoadingTileMap()) return false;
+
+    const int32 GroupStart = UndoGroups.Pop(EAllowShrinking::No);
+
+    // RecordEdit keeps cells distinct within a group, so the whole group can go back in one batch
+    TArray<FIntPoint> Cells;
+    TArray<FTileCell> Tiles;
+    for (int32 Index = UndoStack.Num() - 1; Index >= GroupStart; Index--)
+    {
+        Cells.Add(UndoStack[Index].Cell);
+        Tiles.Add(UndoStack[Index].Before);
+    }
+    UndoStack.SetNum(GroupStart, EAllowShrinking::No);
+
+    SetTiles(Cells, Tiles, false);
+    InvalidateCursor();
+    return true;
+}
+
+int32 ATileGameManager::SetTiles(const TArray<FIntPoint>& Cells, const TArray<FTileCell>& Tiles, bool bRecordUndo)
+{
+    check(Cells.Num() == Tiles.Num());
+
+    // Removals go straight through; additions are gathered per tile type and chunk and added together afterwards
+    TArray<FTileInstanceBatch> Batches;
+    TMap<TPair<int32, FIntPoint>, int32> BatchIndices;
+    int32 NumChanged = 0;
+
+    for (int32 i = 0; i < Cells.Num(); i++)
+    {
+        const FIntPoint& Cell = Cells[i];
+        const FTileCell& Tile = Tiles[i];
+        if (!Tile.IsEmpty() && !TileTypes.IsValidIndex(Tile.TileType)) continue;
+
+        FTileCell Before;
+        if (const FTileCell* Existing = TileMap.Find(Cell))
+        {
+            if (Existing->TileType == Tile.TileType && Existing->Rotation == Tile.Rotation) continue;
+
+            Before = *Existing;
+            if (Tile.IsEmpty()) TileMap.Remove(Cell);
+            RemoveTileInstance(Cell, Before);
+        }
+        else if (Tile.IsEmpty())
+        {
+            continue;
+        }
+
+        if (!Tile.IsEmpty())
+        {
+            FTileCell& Placed = TileMap.Set(Cell, Tile);
+            Placed.InstanceIndex = INDEX_NONE;
+
+            const FIntPoint ChunkCoord = FTileMap::GetChunkCoord(Cell);
+            int32& BatchIndex = BatchIndices.FindOrAdd(TPair<int32, FIntPoint>(Tile.TileType, ChunkCoord), INDEX_NONE);
+            if (BatchIndex == INDEX_NONE)
+            {
+                BatchIndex = Batches.Num();
+                FTileInstanceBatch& NewBatch = Batches.AddDefaulted_GetRef();
+                NewBatch.TileType = Tile.TileType;
+                NewBatch.ChunkCoord = ChunkCoord;
+            }
+
+            FTileInstanceBatch& Batch = Batches[BatchIndex];
+            Batch.Cells.Add(Cell);
+            Batch.Transforms.Add(GetTileTransform(Cell, Tile));
+        }
+
+        if (bRecordUndo) RecordEdit(Cell, Before, Tile);
+        MarkCollisionDirty(Cell);
+        NumChanged++;
+    }
+
+    for (const FTileInstanceBatch& Batch : Batches)
+    {
+        const int32 FirstIndex = TileTypes[Batch.TileType]->AddTileInstances(Batch.ChunkCoord, Batch.Transforms, Batch.Cells);
+        for (int32 i = 0; i < Batch.Cells.Num(); i++)
+        {
+            TileMap.Find(Batch.Cells[i])->InstanceIndex = FirstIndex + i;
+        }
+    }
+
+    return NumChanged;
+}
+
+bool ATileGameManager::GetFloodFillCells(const FIntPoint& Start, TArray<FIntPoint>& OutCells) const
+{
+    // With auto-tiling, all the variants count as one tile type
+    auto GetFillType = [this](const FTileCell* Tile)
+    {
+        if (Tile == nullptr) return INDEX_NONE;
+        return bAutoTile && IsAutoTileType(Tile->TileType) ? (int32)TileTypes.Num() : (int32)Tile->TileType;
+    };
+    const int32 FillType = GetFillType(TileMap.Find(Start));
+
+    TSet<FIntPoint> Visited;
+    Visited.Add(Start);
+    OutCells.Reset();
+    OutCells.Add(Start);
+
+    static const FIntPoint Neighbours[] = { FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1) };
+
+    // OutCells doubles as the queue
+    for (int32 Next = 0; Next < OutCells.Num(); Next++)
+    {
+        const FIntPoint Cell = OutCells[Next];
+        for (const FIntPoint& Offset : Neighbours)
+        {
+            const FIntPoint Neighbour = Cell + Offset;
+            if (!IsCellInBounds(Neighbour) || Visited.Contains(Neighbour)) continue;
+
+            if (GetFillType(TileMap.Find(Neighbour)) != FillType) continue;
+
+            if (OutCells.Num() >= MaxFillCells) return false;
+
+            Visited.Add(Neighbour);
+            OutCells.Add(Neighbour);
+        }
+    }
+    return true;
+}
+
+void ATileGameManager::RemoveTileInstance(const FIntPoint& Cell, const FTileCell& Tile)
+{
+    ATileBase* TileActor = TileTypes[Tile.TileType];
+
+    // The last instance of the tile type in this chunk fills the gap; point its cell at the new index
+    FIntPoint MovedCell;
+    if (TileActor->RemoveTileInstance(Cell, Tile.InstanceIndex, MovedCell))
+    {
+        FTileCell* Moved = TileMap.Find(MovedCell);
+        check(Moved && Moved->TileType == Tile.TileType);
+        Moved->InstanceIndex = Tile.InstanceIndex;
+    }
+}
+
+// Neighbour directions in mask bit order. A quarter turn of yaw takes each onto the next.
+static const FIntPoint AutoTileNeighbours[] = { FIntPoint(1, 0), FIntPoint(0, 1), FIntPoint(-1, 0), FIntPoint(0, -1) };
+
+// Neighbour mask of each variant at rotation 0, in the order of AutoTileVariants
+static const uint8 AutoTileVariantMasks[] = { 0x0, 0x1, 0x5, 0x3, 0x7, 0xF };
+
+struct FAutoTileEntry
+{
+    uint8 Variant;
+    uint8 Rotation;
+};
+
+// Variant and rotation for each of the 16 neighbour masks, found by turning every variant through all four rotations
+static const FAutoTileEntry* GetAutoTileTable()
+{
+    static FAutoTileEntry Table[16];
+    static bool bBuilt = false;
+    if (!bBuilt)
+    {
+        for (uint8 Variant = 0; Variant < UE_ARRAY_COUNT(AutoTileVariantMasks); Variant++)
+        {
+            uint8 Mask = AutoTileVariantMasks[Variant];
+            for (uint8 Rotation = 0; Rotation < 4; Rotation++)
+            {
+                Table[Mask] = { Variant, Rotation };
+                Mask = ((Mask << 1) | (Mask >> 3)) & 0xF;
+            }
+        }
+        bBuilt = true;
+    }
+    return Table;
+}
+
+bool ATileGameManager::IsAutoTileType(int32 TileType) const
+{
+    return TileType != INDEX_NONE && AutoTileVariants.Contains(TileType);
+}
+
+void ATileGameManager::UpdateAutoTiles(const TArray<FIntPoint>& Cells, bool bRecordUndo)
+{
+    // Only the edited cells and their direct neighbours can have a different mask now
+    TSet<FIntPoint> Affected;
+    Affected.Reserve(Cells.Num() * 2);
+    for (const FIntPoint& Cell : Cells)
+    {
+        Affected.Add(Cell);
+        for (const FIntPoint& Offset : AutoTileNeighbours)
+        {
+            Affected.Add(Cell + Offset);
+        }
+    }
+
+    const FAutoTileEntry* Table = GetAutoTileTable();
+
+    TArray<FIntPoint> VariantCells;
+    TArray<FTileCell> VariantTiles;
+
+    // Cells keeping their variant only need their instance turned, done per tile type in one pass
+    TMap<int32, FTileInstanceBatch> Turned;
+
+    for (const FIntPoint& Cell : Affected)
+    {
+        FTileCell* Tile = TileMap.Find(Cell);
+        if (Tile == nullptr || !IsAutoTileType(Tile->TileType)) continue;
+
+        uint8 Mask = 0;
+        for (int32 Bit = 0; Bit < UE_ARRAY_COUNT(AutoTileNeighbours); Bit++)
+        {
+            const FTileCell* Neighbour = TileMap.Find(Cell + AutoTileNeighbours[Bit]);
+            if (Neighbour && IsAutoTileType(Neighbour->TileType)) Mask |= 1 << Bit;
+        }
+
+        const FAutoTileEntry& Entry = Table[Mask];
+        const int32 TileType = AutoTileVariants[Entry.Variant];
+        if (Tile->TileType == TileType && Tile->Rotation == Entry.Rotation) continue;
 
-    if (Input->WasJustPressed(EKeys::LeftMouseButton))
+        if (Tile->TileType != TileType)
+        {
+            FTileCell NewTile;
+            NewTile.TileType = TileType;
+            NewTile.Rotation = Entry.Rotation;
+            VariantCells.Add(Cell);
+            VariantTiles.Add(NewTile);
+            continue;
+        }
+
+        const FTileCell Before = *Tile;
+        Tile->Rotation = Entry.Rotation;
+
+        FTileInstanceBatch& Batch = Turned.FindOrAdd(TileType);
+        Batch.Cells.Add(Cell);
+        Batch.Rotations.Add(Entry.Rotation);
+        Batch.InstanceIndices.Add(Tile->InstanceIndex);
+        Batch.Transforms.Add(GetTileTransform(Cell, *Tile));
+
+        if (bRecordUndo) RecordEdit(Cell, Before, *Tile);
+        MarkCollisionDirty(Cell);
+    }
+
+    for (const auto& Pair : Turned)
     {
-        int GridX = GridLoc.X / GridSize + MapExtendInGrids;
-        int GridY = GridLoc.Y / GridSize + MapExtendInGrids;
+        TileTypes[Pair.Key]->UpdateTileInstances(Pair.Value.Cells, Pair.Value.InstanceIndices, Pair.Value.Transforms);
+    }
+
+    // A variant change never changes occupancy, so it can't affect any other cell's mask
+    SetTiles(VariantCells, VariantTiles, bRecordUndo);
+}
+
+FTransform ATileGameManager::GetTileTransform(const FIntPoint& Cell, const FTileCell& Tile) const
+{
+    const FTransform TileTransform(FRotator(0.0f, Tile.Rotation * 90.0f, 0.0f), CellToWorld(Cell));
+    return TileTypes[Tile.TileType]->InstancedMesh->GetRelativeTransform() * TileTransform;
+}
+
+bool ATileGameManager::IsCellInBounds(const FIntPoint& Cell) const
+{
+    return MapExtendInGrids <= 0 || (FMath::Abs(Cell.X) <= MapExtendInGrids && FMath::Abs(Cell.Y) <= MapExtendInGrids);
+}
 
-        if (GridX < 0 || GridY < 0 || GridX >= MapExtendInGrids * 2 || GridY >= MapExtendInGrids * 2) return;
-        if (Map[GridX][GridY] != nullptr) return;
+void ATileGameManager::BeginUndoGroup()
+{
+    if (UndoDepth <= 0) return;
 
-        if (TileTypes.IsValidIndex(CurrentTileIndex))
+    // Drop the oldest groups to make room for this one
+    if (UndoGroups.Num() >= UndoDepth)
+    {
+        const int32 NumDropped = UndoGroups.Num() - UndoDepth + 1;
+        const int32 NumEdits = UndoGroups.IsValidIndex(NumDropped) ? UndoGroups[NumDropped] : UndoStack.Num();
+
+        UndoStack.RemoveAt(0, NumEdits, EAllowShrinking::No);
+        UndoGroups.RemoveAt(0, NumDropped, EAllowShrinking::No);
+        for (int32& GroupStart : UndoGroups)
         {
-            ATileBase* SelectedTile = TileTypes[CurrentTileIndex];
-            Map[GridX][GridY] = SelectedTile;
+            GroupStart -= NumEdits;
+        }
+    }
 
-            FTransform TileTransform(FRotator(0.0f, CurrentRotation, 0.0f), GridLoc + GridOffset);
-            SelectedTile->InstancedMesh->AddInstance(
-                SelectedTile->InstancedMesh->GetRelativeTransform() * TileTransform, true);
+    UndoGroups.Add(UndoStack.Num());
+    GroupEdits.Reset();
+}
+
+void ATileGameManager::EndUndoGroup()
+{
+    // Don't keep groups where nothing changed
+    if (UndoGroups.Num() > 0 && UndoGroups.Last() == UndoStack.Num()) UndoGroups.Pop(EAllowShrinking::No);
+}
+
+void ATileGameManager::RecordEdit(const FIntPoint& Cell, const FTileCell& Before, const FTileCell& After)
+{
+    if (UndoDepth <= 0 || UndoGroups.Num() == 0) return;
+
+    // Auto-tiling can change a cell the edit just changed; keep one entry per cell with the first Before and last After
+    if (const int32* Existing = GroupEdits.Find(Cell))
+    {
+        UndoStack[*Existing].After = After;
+        return;
+    }
+
+    GroupEdits.Add(Cell, UndoStack.Num());
+    UndoStack.Add({ Cell, Before, After });
+}
+
+FIntPoint ATileGameManager::WorldToCell(const FVector& Location) const
+{
+    return FIntPoint(
+        FMath::RoundToInt((Location.X - GridOffset.X) / GridSize),
+        FMath::RoundToInt((Location.Y - GridOffset.Y) / GridSize));
+}
+
+FVector ATileGameManager::CellToWorld(const FIntPoint& Cell) const
+{
+    return CellToWorld(Cell, GridSize, GridOffset, BuildPlaneHeight);
+}
+
+FVector ATileGameManager::CellToWorld(const FIntPoint& Cell, int InGridSize, const FVector& InGridOffset, float Height)
+{
+    // Same spot a click on the cell snaps to: GridOffset once for the snapped cell, once more for the tile
+    return FVector(Cell.X * InGridSize + InGridOffset.X * 2, Cell.Y * InGridSize + InGridOffset.Y * 2, Height + InGridOffset.Z);
+}
+
+void ATileGameManager::SaveTileMap(const FString& Path)
+{
+    if (PendingSave.IsValid() || IsLoadingTileMap())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Tile map is busy saving or loading, ignoring save to %s"), *Path);
+        return;
+    }
+
+    TArray<FString> Palette;
+    for (ATileBase* TileType : TileTypes)
+    {
+        Palette.Add(TileType ? TileType->GetName() : FString());
+    }
+
+    PendingPath = FPaths::IsRelative(Path) ? FPaths::Combine(FPaths::ProjectSavedDir(), Path) : Path;
+    PendingStartTime = FPlatformTime::Seconds();
+
+    // Copying is the only part that has to happen on the game thread
+    PendingSave = Async(EAsyncExecution::ThreadPool, [Data = FTileMapFile::Capture(TileMap, Palette), Path = PendingPath]()
+    {
+        return FTileMapFile::Save(Data, Path);
+    });
+}
+
+// What the workers need to place instances, copied off the manager and tile types so they never touch either
+struct FTileLayout
+{
+    TArray<FTransform> BaseTransforms;
+    int GridSize;
+    FVector GridOffset;
+    float Height;
+};
+
+// Turn the codes of one chunk into instance batches, one per tile type. CodeTypes maps the tile type in a code
+// to an index into TileTypes, or INDEX_NONE to skip it.
+static void AppendChunkBatches(const FTileChunkData& Chunk, const TArray<int32>& CodeTypes, const FTileLayout& Layout, FTileMapLoadResult& Result)
+{
+    TMap<int32, int32, TInlineSetAllocator<16>> BatchByType;
+    const FIntPoint Origin = Chunk.Coord * FTileMap::ChunkSize;
+
+    for (int32 Index = 0; Index < Chunk.Codes.Num(); Index++)
+    {
+        if (Chunk.Codes[Index] == 0) continue;
+
+        const FTileCell Tile = FTileMapFile::DecodeCell(Chunk.Codes[Index]);
+        const int32 Type = CodeTypes.IsValidIndex(Tile.TileType) ? CodeTypes[Tile.TileType] : INDEX_NONE;
+        if (Type == INDEX_NONE)
+        {
+            Result.NumSkipped++;
+            continue;
         }
+
+        int32& BatchIndex = BatchByType.FindOrAdd(Type, INDEX_NONE);
+        if (BatchIndex == INDEX_NONE)
+        {
+            BatchIndex = Result.Batches.Num();
+            FTileInstanceBatch& NewBatch = Result.Batches.AddDefaulted_GetRef();
+            NewBatch.TileType = Type;
+            NewBatch.ChunkCoord = Chunk.Coord;
+        }
+
+        const FIntPoint Cell = Origin + FIntPoint(Index & FTileMap::ChunkMask, Index >> FTileMap::ChunkShift);
+        FTileInstanceBatch& Batch = Result.Batches[BatchIndex];
+        Batch.Cells.Add(Cell);
+        Batch.Rotations.Add(Tile.Rotation);
+        Batch.Transforms.Add(Layout.BaseTransforms[Type] * FTransform(FRotator(0.0f, Tile.Rotation * 90.0f, 0.0f),
+            ATileGameManager::CellToWorld(Cell, Layout.GridSize, Layout.GridOffset, Layout.Height)));
+        Result.NumTiles++;
     }
-    else if (Input->WasJustPressed(EKeys::MouseScrollDown))
+}
+
+void ATileGameManager::LoadTileMap(const FString& Path)
+{
+    if (PendingSave.IsValid() || IsLoadingTileMap())
     {
-        CurrentTileIndex = (CurrentTileIndex + 1) % TileTypes.Num();
-        UpdateTilePreview();
+        UE_LOG(LogTemp, Warning, TEXT("Tile map is busy saving or loading, ignoring load of %s"), *Path);
+        return;
     }
-    else if (Input->WasJustPressed(EKeys::MouseScrollUp))
+
+    TArray<FString> TypeNames;
+    FTileLayout Layout = { {}, GridSize, GridOffset, BuildPlaneHeight };
+    for (ATileBase* TileType : TileTypes)
     {
-        CurrentTileIndex = (CurrentTileIndex - 1 + TileTypes.Num()) % TileTypes.Num();
-        UpdateTilePreview();
+        TypeNames.Add(TileType ? TileType->GetName() : FString());
+        Layout.BaseTransforms.Add(TileType ? TileType->InstancedMesh->GetRelativeTransform() : FTransform::Identity);
     }
-    else if (Input->WasJustPressed(EKeys::RightMouseButton))
+
+    PendingPath = FPaths::IsRelative(Path) ? FPaths::Combine(FPaths::ProjectSavedDir(), Path) : Path;
+    PendingStartTime = FPlatformTime::Seconds();
+
+    PendingLoad = Async(EAsyncExecution::ThreadPool, [Path = PendingPath, TypeNames, Layout]()
     {
-        CurrentRotation += 90.0f;
-        if (CurrentRotation >= 360.0f)
-            CurrentRotation = 0.0f;
-        UpdateTilePreview();
+        FTileMapLoadResult Result;
+        TArray<FString> Palette;
+        TArray<int32> PaletteToType;
+
+        Result.bSuccess = FTileMapFile::Load(Path, Palette, [&](const FTileChunkData& Chunk)
+        {
+            // Match palette entries to tile types by name, falling back to the same index unless that slot is empty;
+            // unmatched entries stay INDEX_NONE and their tiles are skipped
+            if (PaletteToType.Num() != Palette.Num())
+            {
+                PaletteToType.Reset();
+                for (int32 i = 0; i < Palette.Num(); i++)
+                {
+                    int32 Type = Palette[i].IsEmpty() ? INDEX_NONE : TypeNames.IndexOfByKey(Palette[i]);
+                    if (Type == INDEX_NONE && TypeNames.IsValidIndex(i) && !TypeNames[i].IsEmpty()) Type = i;
+                    PaletteToType.Add(Type);
+                }
+            }
+
+            AppendChunkBatches(Chunk, PaletteToType, Layout, Result);
+        }, Result.Error);
+
+        return Result;
+    });
+}
+
+void ATileGameManager::GenerateTileMap(const FTileGeneratorSettings& Settings)
+{
+    if (PendingSave.IsValid() || IsLoadingTileMap() || TileTypes.Num() == 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Tile map is busy saving or loading or has no tile types, ignoring generation"));
+        return;
+    }
+
+    FTileGeneratorSettings TypedSettings = Settings;
+    TypedSettings.NumTypes = TileTypes.Num();
+    TypedSettings.Extent = MapExtendInGrids;
+
+    // Generated codes hold tile type indices directly; missing tile types are skipped
+    TArray<int32> CodeTypes;
+    FTileLayout Layout = { {}, GridSize, GridOffset, BuildPlaneHeight };
+    for (int32 Type = 0; Type < TileTypes.Num(); Type++)
+    {
+        CodeTypes.Add(TileTypes[Type] ? Type : INDEX_NONE);
+        Layout.BaseTransforms.Add(TileTypes[Type] ? TileTypes[Type]->InstancedMesh->GetRelativeTransform() : FTransform::Identity);
     }
+
+    PendingPath = FString::Printf(TEXT("generated from seed %d"), Settings.Seed);
+    PendingStartTime = FPlatformTime::Seconds();
+
+    PendingLoad = Async(EAsyncExecution::ThreadPool, [TypedSettings, CodeTypes, Layout]()
+    {
+        const TArray<FIntPoint> Coords = FTileMapGenerator::GetChunkCoords(TypedSettings);
+
+        // Every chunk is its own task writing to its own result; they're joined in order afterwards
+        TArray<FTileMapLoadResult> ChunkResults;
+        ChunkResults.SetNum(Coords.Num());
+        ParallelFor(Coords.Num(), [&](int32 Index)
+        {
+            FTileChunkData Chunk;
+            FTileMapGenerator::GenerateChunk(TypedSettings, Coords[Index], Chunk);
+            AppendChunkBatches(Chunk, CodeTypes, Layout, ChunkResults[Index]);
+        });
+
+        FTileMapLoadResult Result;
+        Result.bSuccess = true;
+        for (FTileMapLoadResult& ChunkResult : ChunkResults)
+        {
+            Result.Batches.Append(MoveTemp(ChunkResult.Batches));
+            Result.NumTiles += ChunkResult.NumTiles;
+            Result.NumSkipped += ChunkResult.NumSkipped;
+        }
+        return Result;
+    });
+}
+
+void ATileGameManager::ApplyLoadedTileMap(FTileMapLoadResult&& Result)
+{
+    if (!Result.bSuccess)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to load tile map %s: %s"), *PendingPath, *Result.Error);
+        return;
+    }
+
+    for (ATileBase* TileType : TileTypes)
+    {
+        if (TileType) TileType->ClearTileInstances();
+    }
+    TileMap.Reset();
+    UndoStack.Reset();
+    UndoGroups.Reset();
+
+    for (auto& Pair : CollisionChunks)
+    {
+        if (Pair.Value) Pair.Value->DestroyComponent();
+    }
+    CollisionChunks.Reset();
+    DirtyCollisionChunks.Reset();
+    CollisionGeneration++;
+
+    CommitResult = MoveTemp(Result);
+    NextCommitBatch = 0;
+    CommitSeconds = 0.0;
+    CommitLoadedBatches();
+}
+
+void ATileGameManager::CommitLoadedBatches()
+{
+    const double Start = FPlatformTime::Seconds();
+
+    // Batches are at most a chunk each, so the budget is never overrun by much
+    while (CommitResult.Batches.IsValidIndex(NextCommitBatch))
+    {
+        const FTileInstanceBatch& Batch = CommitResult.Batches[NextCommitBatch++];
+
+        // The tile type may have gone while the map was read on the worker
+        ATileBase* TileType = TileTypes.IsValidIndex(Batch.TileType) ? TileTypes[Batch.TileType] : nullptr;
+        if (!TileType)
+        {
+            CommitResult.NumTiles -= Batch.Cells.Num();
+            CommitResult.NumSkipped += Batch.Cells.Num();
+            continue;
+        }
+
+        const int32 FirstIndex = TileType->AddTileInstances(Batch.ChunkCoord, Batch.Transforms, Batch.Cells);
+
+        for (int32 i = 0; i < Batch.Cells.Num(); i++)
+        {
+            FTileCell Tile;
+            Tile.TileType = Batch.TileType;
+            Tile.Rotation = Batch.Rotations[i];
+            Tile.InstanceIndex = FirstIndex + i;
+            TileMap.Set(Batch.Cells[i], Tile);
+        }
+        if (Batch.Cells.Num() > 0) MarkCollisionDirty(Batch.Cells[0]);
+
+        if ((FPlatformTime::Seconds() - Start) * 1000.0 >= CommitBudgetMs) break;
+    }
+
+    CommitSeconds += FPlatformTime::Seconds() - Start;
+    if (CommitResult.Batches.IsValidIndex(NextCommitBatch)) return;
+
+    const double TotalSeconds = FPlatformTime::Seconds() - PendingStartTime;
+    UE_LOG(LogTemp, Warning, TEXT("Tile map %s: %d tiles (%d of unknown types skipped) in %d batches, %.1f ms total (%.2fM tiles/s), %.1f ms on the game thread"),
+        *PendingPath, CommitResult.NumTiles, CommitResult.NumSkipped, CommitResult.Batches.Num(),
+        TotalSeconds * 1000.0, CommitResult.NumTiles / FMath::Max(TotalSeconds, 1e-9) / 1e6, CommitSeconds * 1000.0);
+
+    CommitResult = FTileMapLoadResult();
+    NextCommitBatch = INDEX_NONE;
+    InvalidateCursor();
+}
+
+void ATileGameManager::InvalidateCursor()
+{
+    // Tiles and collision changing under a still mouse need a fresh trace to find the cell under the cursor
+    if (auto PlayerController = Cast<ATilePlayerController>(GetWorld()->GetFirstPlayerController()))
+    {
+        PlayerController->InvalidateCursor();
+    }
+}
+
+void ATileGameManager::MarkCollisionDirty(const FIntPoint& Cell)
+{
+    if (bGenerateCollision) DirtyCollisionChunks.Add(FTileMap::GetChunkCoord(Cell));
+}
+
+void ATileGameManager::UpdateCollision()
+{
+    if (PendingCollision.IsValid())
+    {
+        if (!PendingCollision.IsReady()) return;
+
+        TArray<FTileChunkBoxes> Results = PendingCollision.Consume();
+        if (PendingCollisionGeneration != CollisionGeneration) Results.Reset();
+
+        for (const FTileChunkBoxes& Result : Results)
+        {
+            UTileChunkCollisionComponent* Collision = CollisionChunks.FindRef(Result.ChunkCoord);
+            if (Result.Boxes.Num() == 0)
+            {
+                if (Collision) Collision->DestroyComponent();
+                CollisionChunks.Remove(Result.ChunkCoord);
+                continue;
+            }
+
+            if (Collision == nullptr)
+            {
+                Collision = NewObject<UTileChunkCollisionComponent>(this);
+                Collision->SetupAttachment(RootComponent);
+                Collision->RegisterComponent();
+                CollisionChunks.Add(Result.ChunkCoord, Collision);
+            }
+            Collision->SetBoxes(Result.Boxes);
+        }
+
+        // The surface under the cursor may have just appeared or gone
+        if (Results.Num() > 0) InvalidateCursor();
+    }
+
+    if (DirtyCollisionChunks.Num() == 0) return;
+
+    // Blocking bounds of each tile type's mesh; the instance transform places it
+    TArray<FBox> TypeBounds;
+    for (ATileBase* TileType : TileTypes)
+    {
+        const UStaticMesh* Mesh = TileType ? TileType->InstancedMesh->GetStaticMesh() : nullptr;
+        TypeBounds.Add(Mesh && TileType->bHasCollision ? Mesh->GetBoundingBox() : FBox(ForceInit));
+    }
+
+    // Copy each dirty chunk's tile boxes; merging them is left to the worker
+    TArray<FIntPoint> Coords = DirtyCollisionChunks.Array();
+    DirtyCollisionChunks.Reset();
+
+    TArray<TArray<FBox>> CellBoxes;
+    CellBoxes.SetNum(Coords.Num());
+    for (int32 ChunkIndex = 0; ChunkIndex < Coords.Num(); ChunkIndex++)
+    {
+        CellBoxes[ChunkIndex].Init(FBox(ForceInit), FTileMap::ChunkSize * FTileMap::ChunkSize);
+
+        const FTileCell* Cells = TileMap.FindChunk(Coords[ChunkIndex]);
+        if (Cells == nullptr) continue;
+
+        const FIntPoint Origin = Coords[ChunkIndex] * FTileMap::ChunkSize;
+        for (int32 Index = 0; Index < FTileMap::ChunkSize * FTileMap::ChunkSize; Index++)
+        {
+            const FTileCell& Tile = Cells[Index];
+            if (Tile.IsEmpty() || Tile.InstanceIndex == INDEX_NONE || !TypeBounds[Tile.TileType].IsValid) continue;
+
+            const FIntPoint Cell = Origin + FIntPoint(Index & FTileMap::ChunkMask, Index >> FTileMap::ChunkShift);
+            CellBoxes[ChunkIndex][Index] = TypeBounds[Tile.TileType].TransformBy(TileTypes[Tile.TileType]->GetTileInstanceTransform(Cell, Tile.InstanceIndex));
+        }
+    }
+
+    PendingCollisionGeneration = CollisionGeneration;
+    PendingCollision = Async(EAsyncExecution::ThreadPool, [Coords = MoveTemp(Coords), CellBoxes = MoveTemp(CellBoxes)]()
+    {
+        TArray<FTileChunkBoxes> Results;
+        Results.SetNum(Coords.Num());
+        ParallelFor(Coords.Num(), [&](int32 ChunkIndex)
+        {
+            Results[ChunkIndex].ChunkCoord = Coords[ChunkIndex];
+            UTileChunkCollisionComponent::MergeCellBoxes(CellBoxes[ChunkIndex], Results[ChunkIndex].Boxes);
+        });
+        return Results;
+    });
 }
 
 void ATileGameManager::UpdateTilePreview()
@@ -115,3 +925,50 @@ void ATileGameManager::UpdateTilePreview()
     }
 }
 
+static ATileGameManager* FindTileGameManager(UWorld* World)
+{
+    TActorIterator<ATileGameManager> It(World);
+    return It ? *It : nullptr;
+}
+
+// Usage: HW3.SaveTiles <Path>
+static void SaveTilesCommand(const TArray<FString>& Args, UWorld* World)
+{
+    ATileGameManager* Manager = FindTileGameManager(World);
+    if (Manager && Args.Num() > 0) Manager->SaveTileMap(Args[0]);
+}
+
+// Usage: HW3.LoadTiles <Path>
+static void LoadTilesCommand(const TArray<FString>& Args, UWorld* World)
+{
+    ATileGameManager* Manager = FindTileGameManager(World);
+    if (Manager && Args.Num() > 0) Manager->LoadTileMap(Args[0]);
+}
+
+// Usage: HW3.GenerateTiles [Seed=1] [Radius=4] [EmptyFraction=0.35]
+static void GenerateTilesCommand(const TArray<FString>& Args, UWorld* World)
+{
+    ATileGameManager* Manager = FindTileGameManager(World);
+    if (Manager == nullptr) return;
+
+    FTileGeneratorSettings Settings;
+    Settings.Seed = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1;
+    Settings.Radius = FMath::Clamp(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 4, 1, 256);
+    Settings.EmptyFraction = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 0.35f;
+    Manager->GenerateTileMap(Settings);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SaveTilesConsoleCommand(
+    TEXT("HW3.SaveTiles"),
+    TEXT("Save the tile map in the background; relative paths go to the Saved directory. Args: <Path>"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SaveTilesCommand));
+
+static FAutoConsoleCommandWithWorldAndArgs LoadTilesConsoleCommand(
+    TEXT("HW3.LoadTiles"),
+    TEXT("Replace the tile map with a saved one; relative paths are read from the Saved directory. Args: <Path>"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&LoadTilesCommand));
+
+static FAutoConsoleCommandWithWorldAndArgs GenerateTilesConsoleCommand(
+    TEXT("HW3.GenerateTiles"),
+    TEXT("Replace the tile map with a procedurally generated one. Args: [Seed=1] [Radius=4] (in chunks) [EmptyFraction=0.35]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&GenerateTilesCommand));
@@ -5,9 +5,62 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "TileBase.h"
+#include "TileMap.h"
+#include "TileMapFile.h"
+#include "TileMapGenerator.h"
+#include "TileChunkCollisionComponent.h"
+#include "Async/Future.h"
 #include "TileGameManager.generated.h"
 
-#define MAX_MAP_GRID_SIZE 100
+// One change to one cell, enough to put the cell back the way it was
+struct FTileEdit
+{
+	FIntPoint Cell;
+	FTileCell Before;
+	FTileCell After;
+};
+
+// Merged collision boxes of one chunk, built off the game thread
+struct FTileChunkBoxes
+{
+	FIntPoint ChunkCoord;
+	TArray<FBox> Boxes;
+};
+
+UENUM()
+enum class ETilePlacementTool : uint8
+{
+	Single,
+	// Fill the rectangle between where the button went down and where it came up
+	Rectangle,
+	Line,
+	// Fill the connected cells holding the same tile type as the clicked one
+	FloodFill
+};
+
+// Tiles of one type in one chunk with their instance transforms, ready for one AddInstances call
+struct FTileInstanceBatch
+{
+	int32 TileType;
+	FIntPoint ChunkCoord;
+	TArray<FIntPoint> Cells;
+	TArray<uint8> Rotations;
+	TArray<FTransform> Transforms;
+
+	// Only set when updating instances already placed
+	TArray<int32> InstanceIndices;
+};
+
+struct FTileMapLoadResult
+{
+	bool bSuccess = false;
+	FString Error;
+	TArray<FTileInstanceBatch> Batches;
+	int32 NumTiles = 0;
+
+	// Tiles whose type isn't among TileTypes
+	int32 NumSkipped = 0;
+};
 
 UCLASS()
 class HW3_API ATileGameManager : public AActor
@@ -33,7 +86,17 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	void OnActorInteraction(AActor* Actor, FVector& Location, bool IsPressed);
+	// Move the selection to the cell under Location, on the build plane; does nothing unless the cell changed
+	bool SetCursorLocation(const FVector& Location);
+
+	// Left button down and up; what happens in between depends on PlacementTool
+	void BeginPlacement();
+	void EndPlacement();
+
+	void EraseTileAtCursor();
+	void SelectTileType(int32 Offset);
+	void SelectNextPlacementTool();
+	void RotateCurrentTile();
 	void UpdateTilePreview();
 
 	UPROPERTY(EditAnywhere)
@@ -42,14 +105,147 @@ public:
 	UPROPERTY(EditAnywhere)
 	FVector GridOffset;
 
+	// Height of the floor every tile sits on. Tiles never take their height from the cursor trace, which can
+	// hit the top of another tile once collision is on
+	UPROPERTY(EditAnywhere)
+	float BuildPlaneHeight;
+
 	UPROPERTY(EditAnywhere)
 	TArray<ATileBase*> TileTypes;
 
+	// How many cells from the origin tiles may be placed in each direction; 0 for no limit
 	UPROPERTY(EditAnywhere)
 	int MapExtendInGrids;
 
 	int CurrentTileIndex;
 	float CurrentRotation;
 
-	ATileBase* Map[MAX_MAP_GRID_SIZE][MAX_MAP_GRID_SIZE];
+	// Cell the selection is on, valid once the cursor has been over the build area
+	FIntPoint CursorCell;
+	bool bHasCursor;
+
+	UPROPERTY(EditAnywhere)
+	ETilePlacementTool PlacementTool;
+
+	// Flood fills reaching more cells than this are refused, which also stops fills of unbounded empty space
+	UPROPERTY(EditAnywhere)
+	int MaxFillCells;
+
+	// Pick each tile's variant and rotation from which of its four neighbours hold auto-tiled tiles
+	UPROPERTY(EditAnywhere)
+	bool bAutoTile;
+
+	// Indices into TileTypes of the auto-tile variants, in order: isolated, end, straight, corner, tee, cross.
+	// At rotation 0 the end connects towards +X, the straight along X, the corner towards +X and +Y and the tee
+	// towards +X, +Y and -X. Painting any of these types while bAutoTile is on places the matching variant.
+	UPROPERTY(EditAnywhere)
+	TArray<int32> AutoTileVariants;
+
+	// Single edits and whole tool strokes kept for undo
+	UPROPERTY(EditAnywhere)
+	int UndoDepth;
+
+	// Put a tile on a cell, replacing a different one already there. Nothing happens if the same tile is already there.
+	bool PlaceTile(const FIntPoint& Cell, int32 TileType, uint8 Rotation, bool bRecordUndo = true);
+
+	bool EraseTile(const FIntPoint& Cell, bool bRecordUndo = true);
+
+	// Put the same tile on many distinct cells, undone as one edit. New instances are added with one call per chunk mesh.
+	int32 PlaceTiles(const TArray<FIntPoint>& Cells, int32 TileType, uint8 Rotation, bool bRecordUndo = true);
+
+	// Undo the last single edit or tool stroke
+	bool UndoLastEdit();
+
+	// Write the map on a worker thread; the map is copied first, so editing can go on meanwhile
+	void SaveTileMap(const FString& Path);
+
+	// Decode the file and lay out the instances on a worker thread, then replace the map with it in one go
+	void LoadTileMap(const FString& Path);
+
+	// Fill the map procedurally, one task per chunk, replacing what's there
+	void GenerateTileMap(const FTileGeneratorSettings& Settings);
+
+	// Give placed tiles collision: one body of merged boxes per chunk, rebuilt in the background for chunks that changed
+	UPROPERTY(EditAnywhere)
+	bool bGenerateCollision;
+
+	// Loaded or generated maps are added to the meshes over several frames, spending at most this long per frame
+	UPROPERTY(EditAnywhere)
+	float CommitBudgetMs;
+
+	// True from starting a load or generation until its last tile is placed
+	bool IsLoadingTileMap() const { return PendingLoad.IsValid() || NextCommitBatch != INDEX_NONE; }
+
+	// Cell under a world location, relative to GridOffset
+	FIntPoint WorldToCell(const FVector& Location) const;
+
+	// Where a tile on Cell is placed, on the build plane
+	FVector CellToWorld(const FIntPoint& Cell) const;
+	static FVector CellToWorld(const FIntPoint& Cell, int InGridSize, const FVector& InGridOffset, float Height);
+
+	FTileMap TileMap;
+
+private:
+	void RemoveTileInstance(const FIntPoint& Cell, const FTileCell& Tile);
+	FTransform GetTileTransform(const FIntPoint& Cell, const FTileCell& Tile) const;
+	bool IsCellInBounds(const FIntPoint& Cell) const;
+
+	// A user edit: SetTiles plus auto-tiling, recorded as one undo group
+	int32 EditTiles(const TArray<FIntPoint>& Cells, const TArray<FTileCell>& Tiles, bool bRecordUndo);
+
+	// Change each Cells[i] to Tiles[i], empty tiles erasing; returns how many cells changed
+	int32 SetTiles(const TArray<FIntPoint>& Cells, const TArray<FTileCell>& Tiles, bool bRecordUndo);
+
+	bool IsAutoTileType(int32 TileType) const;
+
+	// Re-pick the variant and rotation of the auto-tiled cells among Cells and their neighbours
+	void UpdateAutoTiles(const TArray<FIntPoint>& Cells, bool bRecordUndo);
+
+	// Connected cells with the same tile type as Start; false if there are more than MaxFillCells
+	bool GetFloodFillCells(const FIntPoint& Start, TArray<FIntPoint>& OutCells) const;
+
+	// Edits recorded between these go on the undo stack as one
+	void BeginUndoGroup();
+	void EndUndoGroup();
+	void RecordEdit(const FIntPoint& Cell, const FTileCell& Before, const FTileCell& After);
+	void ApplyLoadedTileMap(FTileMapLoadResult&& Result);
+	void CommitLoadedBatches();
+
+	void MarkCollisionDirty(const FIntPoint& Cell);
+	void InvalidateCursor();
+
+	// Apply finished collision builds and start a build of the chunks changed since
+	void UpdateCollision();
+
+	TFuture<bool> PendingSave;
+	TFuture<FTileMapLoadResult> PendingLoad;
+	FString PendingPath;
+	double PendingStartTime;
+
+	// Loaded batches still being added, from NextCommitBatch on
+	FTileMapLoadResult CommitResult;
+	int32 NextCommitBatch;
+	double CommitSeconds;
+
+	TSet<FIntPoint> DirtyCollisionChunks;
+	TFuture<TArray<FTileChunkBoxes>> PendingCollision;
+
+	// Bumped when the map is replaced, so builds started before then are thrown away
+	int32 CollisionGeneration;
+	int32 PendingCollisionGeneration;
+
+	UPROPERTY()
+	TMap<FIntPoint, UTileChunkCollisionComponent*> CollisionChunks;
+
+	TArray<FTileEdit> UndoStack;
+
+	// Where each undo group starts in UndoStack
+	TArray<int32> UndoGroups;
+
+	// Where each cell edited in the open undo group is in UndoStack
+	TMap<FIntPoint, int32> GroupEdits;
+
+	// Cell the left button went down on, for the rectangle and line tools
+	FIntPoint PlacementStart;
+	bool bPlacing;
 };
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileMap.h"
+#include "HAL/IConsoleManager.h"
+
+FTileMap::FTileMap() : NumTiles(0)
+{
+}
+
+const FTileCell* FTileMap::Find(const FIntPoint& Cell) const
+{
+	const TUniquePtr<FChunk>* Chunk = Chunks.Find(GetChunkCoord(Cell));
+	if (!Chunk) return nullptr;
+
+	const FTileCell& Tile = (*Chunk)->Cells[GetLocalIndex(Cell)];
+	return Tile.IsEmpty() ? nullptr : &Tile;
+}
+
+FTileCell* FTileMap::Find(const FIntPoint& Cell)
+{
+	return const_cast<FTileCell*>(static_cast<const FTileMap*>(this)->Find(Cell));
+}
+
+FTileCell& FTileMap::Set(const FIntPoint& Cell, const FTileCell& Tile)
+{
+	check(!Tile.IsEmpty());
+
+	TUniquePtr<FChunk>& Chunk = Chunks.FindOrAdd(GetChunkCoord(Cell));
+	if (!Chunk)
+	{
+		Chunk = MakeUnique<FChunk>();
+	}
+
+	FTileCell& Slot = Chunk->Cells[GetLocalIndex(Cell)];
+	if (Slot.IsEmpty())
+	{
+		Chunk->NumTiles++;
+		NumTiles++;
+	}
+
+	Slot = Tile;
+	return Slot;
+}
+
+bool FTileMap::Remove(const FIntPoint& Cell, FTileCell* OutRemoved)
+{
+	const FIntPoint ChunkCoord = GetChunkCoord(Cell);
+	TUniquePtr<FChunk>* Chunk = Chunks.Find(ChunkCoord);
+	if (!Chunk) return false;
+
+	FTileCell& Slot = (*Chunk)->Cells[GetLocalIndex(Cell)];
+	if (Slot.IsEmpty()) return false;
+
+	if (OutRemoved) *OutRemoved = Slot;
+	Slot = FTileCell();
+	NumTiles--;
+
+	if (--(*Chunk)->NumTiles == 0)
+	{
+		Chunks.Remove(ChunkCoord);
+	}
+
+	return true;
+}
+
+const FTileCell* FTileMap::FindChunk(const FIntPoint& ChunkCoord) const
+{
+	const TUniquePtr<FChunk>* Chunk = Chunks.Find(ChunkCoord);
+	return Chunk ? (*Chunk)->Cells : nullptr;
+}
+
+void FTileMap::Reset()
+{
+	Chunks.Reset();
+	NumTiles = 0;
+}
+
+SIZE_T FTileMap::GetAllocatedSize() const
+{
+	return Chunks.GetAllocatedSize() + Chunks.Num() * sizeof(FChunk);
+}
+
+// Usage: HW3.BenchmarkTileMap [Tiles=100000] [Extent=1000] [Seed=1]
+static void BenchmarkTileMap(const TArray<FString>& Args)
+{
+	const int32 NumTiles = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100000);
+	const int32 Extent = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1000);
+	FRandomStream Random(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1);
+
+	TArray<FIntPoint> Cells;
+	Cells.Reserve(NumTiles);
+	for (int32 i = 0; i < NumTiles; i++)
+	{
+		Cells.Add(FIntPoint(Random.RandRange(-Extent, Extent), Random.RandRange(-Extent, Extent)));
+	}
+
+	FTileMap Map;
+	FTileCell Tile;
+	Tile.TileType = 0;
+
+	double Start = FPlatformTime::Seconds();
+	for (const FIntPoint& Cell : Cells)
+	{
+		Map.Set(Cell, Tile);
+	}
+	const double SetSeconds = FPlatformTime::Seconds() - Start;
+
+	int32 Found = 0;
+	Start = FPlatformTime::Seconds();
+	for (const FIntPoint& Cell : Cells)
+	{
+		Found += Map.IsOccupied(Cell + FIntPoint(1, 0)) ? 1 : 0;
+	}
+	const double FindSeconds = FPlatformTime::Seconds() - Start;
+
+	UE_LOG(LogTemp, Warning, TEXT("Tile map: %d tiles in %d chunks over +-%d cells, %.1f KB; set %.1f ns/tile, find %.1f ns/lookup (%d hits)"),
+		Map.Num(), Map.NumChunks(), Extent, Map.GetAllocatedSize() / 1024.0,
+		SetSeconds * 1e9 / NumTiles, FindSeconds * 1e9 / NumTiles, Found);
+}
+
+static FAutoConsoleCommand BenchmarkTileMapCommand(
+	TEXT("HW3.BenchmarkTileMap"),
+	TEXT("Fill a tile map with random tiles and time placement and lookup. Args: [Tiles=100000] [Extent=1000] [Seed=1]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTileMap));
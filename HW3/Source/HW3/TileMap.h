@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// One placed tile: which type it is, how it's turned and which instance of the type's mesh draws it
+struct FTileCell
+{
+	// Index into ATileGameManager::TileTypes; INDEX_NONE marks an empty cell
+	int16 TileType = INDEX_NONE;
+
+	// Quarter turns around Z, 0-3
+	uint8 Rotation = 0;
+
+	int32 InstanceIndex = INDEX_NONE;
+
+	bool IsEmpty() const { return TileType == INDEX_NONE; }
+};
+
+/**
+ * Sparse grid of tiles with no fixed bounds. Cells are grouped in 32x32 chunks kept in a hash map,
+ * so a lookup is one hash plus an array index, and memory grows with the area actually built on
+ * rather than with the size of the world. Chunks are freed when their last tile is removed.
+ */
+class HW3_API FTileMap
+{
+public:
+	static constexpr int32 ChunkShift = 5;
+	static constexpr int32 ChunkSize = 1 << ChunkShift;
+	static constexpr int32 ChunkMask = ChunkSize - 1;
+
+	FTileMap();
+
+	// The tile at Cell, or nullptr if the cell is empty
+	const FTileCell* Find(const FIntPoint& Cell) const;
+	FTileCell* Find(const FIntPoint& Cell);
+
+	bool IsOccupied(const FIntPoint& Cell) const { return Find(Cell) != nullptr; }
+
+	// Place a tile, replacing whatever was on the cell
+	FTileCell& Set(const FIntPoint& Cell, const FTileCell& Tile);
+
+	// Clear a cell; returns false if it was already empty
+	bool Remove(const FIntPoint& Cell, FTileCell* OutRemoved = nullptr);
+
+	void Reset();
+
+	// The ChunkSize * ChunkSize cells of a chunk, row by row, or nullptr if the chunk has no tiles
+	const FTileCell* FindChunk(const FIntPoint& ChunkCoord) const;
+
+	int32 Num() const { return NumTiles; }
+	int32 NumChunks() const { return Chunks.Num(); }
+	SIZE_T GetAllocatedSize() const;
+
+	// Chunk holding a cell; shifts round towards negative infinity, so negative cells work too
+	static FIntPoint GetChunkCoord(const FIntPoint& Cell) { return FIntPoint(Cell.X >> ChunkShift, Cell.Y >> ChunkShift); }
+
+	// Call Visitor(const FIntPoint& Cell, const FTileCell& Tile) for every placed tile, chunk by chunk
+	template <typename FunctorType>
+	void ForEachTile(FunctorType&& Visitor) const
+	{
+		for (const auto& Pair : Chunks)
+		{
+			const FIntPoint Origin = Pair.Key * ChunkSize;
+			const FChunk& Chunk = *Pair.Value;
+			for (int32 Index = 0; Index < ChunkSize * ChunkSize; Index++)
+			{
+				if (!Chunk.Cells[Index].IsEmpty())
+				{
+					Visitor(Origin + FIntPoint(Index & ChunkMask, Index >> ChunkShift), Chunk.Cells[Index]);
+				}
+			}
+		}
+	}
+
+private:
+	struct FChunk
+	{
+		FTileCell Cells[ChunkSize * ChunkSize];
+		int32 NumTiles = 0;
+	};
+
+	static int32 GetLocalIndex(const FIntPoint& Cell) { return ((Cell.Y & ChunkMask) << ChunkShift) | (Cell.X & ChunkMask); }
+
+	TMap<FIntPoint, TUniquePtr<FChunk>> Chunks;
+	int32 NumTiles;
+};
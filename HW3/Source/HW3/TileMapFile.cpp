@@ -0,0 +1,332 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileMapFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	const uint32 FileMagic = 0x54335748; // "HW3T"
+	const uint16 FileVersion = 1;
+	const int32 CellsPerChunk = FTileMap::ChunkSize * FTileMap::ChunkSize;
+
+	enum class EChunkEncoding : uint8
+	{
+		RunLength,
+		BitPacked
+	};
+
+	void WriteRunLength(FArchive& Ar, const TArray<uint16>& Codes)
+	{
+		TArray<TPair<uint32, uint32>> Runs;
+		for (uint16 Code : Codes)
+		{
+			if (Runs.Num() > 0 && Runs.Last().Key == Code) Runs.Last().Value++;
+			else Runs.Emplace(Code, 1);
+		}
+
+		uint32 NumRuns = Runs.Num();
+		Ar.SerializeIntPacked(NumRuns);
+		for (TPair<uint32, uint32>& Run : Runs)
+		{
+			Ar.SerializeIntPacked(Run.Key);
+			Ar.SerializeIntPacked(Run.Value);
+		}
+	}
+
+	void WriteBitPacked(FArchive& Ar, const TArray<uint16>& Codes, uint8 Bits)
+	{
+		Ar << Bits;
+
+		TArray<uint8> Bytes;
+		Bytes.SetNumZeroed((Codes.Num() * Bits + 7) / 8);
+
+		uint64 Accumulator = 0;
+		int32 Pending = 0;
+		int32 Out = 0;
+		for (uint16 Code : Codes)
+		{
+			Accumulator |= (uint64)Code << Pending;
+			Pending += Bits;
+			while (Pending >= 8)
+			{
+				Bytes[Out++] = (uint8)Accumulator;
+				Accumulator >>= 8;
+				Pending -= 8;
+			}
+		}
+		if (Pending > 0) Bytes[Out++] = (uint8)Accumulator;
+
+		Ar.Serialize(Bytes.GetData(), Bytes.Num());
+	}
+
+	bool ReadChunkCodes(FArchive& Ar, EChunkEncoding Encoding, TArray<uint16>& OutCodes)
+	{
+		OutCodes.Reset();
+
+		if (Encoding == EChunkEncoding::RunLength)
+		{
+			uint32 NumRuns = 0;
+			Ar.SerializeIntPacked(NumRuns);
+			for (uint32 i = 0; i < NumRuns && !Ar.IsError(); i++)
+			{
+				uint32 Code = 0, Count = 0;
+				Ar.SerializeIntPacked(Code);
+				Ar.SerializeIntPacked(Count);
+				if (OutCodes.Num() + (int64)Count > CellsPerChunk || Code > MAX_uint16) return false;
+
+				for (uint32 j = 0; j < Count; j++) OutCodes.Add((uint16)Code);
+			}
+		}
+		else if (Encoding == EChunkEncoding::BitPacked)
+		{
+			uint8 Bits = 0;
+			Ar << Bits;
+			if (Bits == 0 || Bits > 16) return false;
+
+			TArray<uint8> Bytes;
+			Bytes.SetNumUninitialized((CellsPerChunk * Bits + 7) / 8);
+			Ar.Serialize(Bytes.GetData(), Bytes.Num());
+
+			const uint32 Mask = (1u << Bits) - 1;
+			uint64 Accumulator = 0;
+			int32 Pending = 0;
+			int32 In = 0;
+			for (int32 i = 0; i < CellsPerChunk; i++)
+			{
+				while (Pending < Bits)
+				{
+					Accumulator |= (uint64)Bytes[In++] << Pending;
+					Pending += 8;
+				}
+				OutCodes.Add((uint16)(Accumulator & Mask));
+				Accumulator >>= Bits;
+				Pending -= Bits;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		return !Ar.IsError() && OutCodes.Num() == CellsPerChunk;
+	}
+}
+
+FTileCell FTileMapFile::DecodeCell(uint16 Code)
+{
+	FTileCell Tile;
+	if (Code != 0)
+	{
+		Tile.TileType = (Code >> 2) - 1;
+		Tile.Rotation = Code & 3;
+	}
+	return Tile;
+}
+
+FTileMapFileData FTileMapFile::Capture(const FTileMap& Map, const TArray<FString>& Palette)
+{
+	FTileMapFileData Data;
+	Data.Palette = Palette;
+	Data.NumTiles = Map.Num();
+
+	TMap<FIntPoint, int32> ChunkIndices;
+	ChunkIndices.Reserve(Map.NumChunks());
+	Data.Chunks.Reserve(Map.NumChunks());
+
+	Map.ForEachTile([&](const FIntPoint& Cell, const FTileCell& Tile)
+	{
+		const FIntPoint ChunkCoord = FTileMap::GetChunkCoord(Cell);
+		int32& ChunkIndex = ChunkIndices.FindOrAdd(ChunkCoord, INDEX_NONE);
+		if (ChunkIndex == INDEX_NONE)
+		{
+			ChunkIndex = Data.Chunks.Num();
+			FTileChunkData& Chunk = Data.Chunks.AddDefaulted_GetRef();
+			Chunk.Coord = ChunkCoord;
+			Chunk.Codes.SetNumZeroed(CellsPerChunk);
+		}
+
+		const int32 Local = ((Cell.Y & FTileMap::ChunkMask) << FTileMap::ChunkShift) | (Cell.X & FTileMap::ChunkMask);
+		Data.Chunks[ChunkIndex].Codes[Local] = EncodeCell(Tile);
+	});
+
+	return Data;
+}
+
+bool FTileMapFile::Save(const FTileMapFileData& Data, const FString& Path, int64* OutFileSize)
+{
+	const FString TempPath = Path + TEXT(".tmp");
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath));
+	if (!Writer) return false;
+
+	FArchive& Ar = *Writer;
+	uint32 Magic = FileMagic;
+	uint16 Version = FileVersion;
+	Ar << Magic << Version;
+
+	uint32 NumPalette = Data.Palette.Num();
+	Ar.SerializeIntPacked(NumPalette);
+	for (const FString& Name : Data.Palette)
+	{
+		FString Copy = Name;
+		Ar << Copy;
+	}
+
+	uint32 NumChunks = Data.Chunks.Num();
+	Ar.SerializeIntPacked(NumChunks);
+
+	// Each chunk is encoded into a scratch buffer both ways and the smaller one is written
+	TArray<uint8> RunLengthBytes, PackedBytes;
+	for (const FTileChunkData& Chunk : Data.Chunks)
+	{
+		uint16 MaxCode = 0;
+		for (uint16 Code : Chunk.Codes) MaxCode = FMath::Max(MaxCode, Code);
+		const uint8 Bits = FMath::Max<uint8>(1, FMath::FloorLog2(MaxCode) + 1);
+
+		RunLengthBytes.Reset();
+		FMemoryWriter RunLengthWriter(RunLengthBytes);
+		WriteRunLength(RunLengthWriter, Chunk.Codes);
+
+		PackedBytes.Reset();
+		FMemoryWriter PackedWriter(PackedBytes);
+		WriteBitPacked(PackedWriter, Chunk.Codes, Bits);
+
+		FIntPoint Coord = Chunk.Coord;
+		EChunkEncoding Encoding = RunLengthBytes.Num() <= PackedBytes.Num() ? EChunkEncoding::RunLength : EChunkEncoding::BitPacked;
+		TArray<uint8>& Bytes = Encoding == EChunkEncoding::RunLength ? RunLengthBytes : PackedBytes;
+
+		Ar << Coord << Encoding;
+		Ar.Serialize(Bytes.GetData(), Bytes.Num());
+	}
+
+	const int64 FileSize = Ar.Tell();
+	const bool bSuccess = !Ar.IsError() && Writer->Close();
+	Writer.Reset();
+
+	if (!bSuccess || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+	{
+		IFileManager::Get().Delete(*TempPath);
+		return false;
+	}
+
+	if (OutFileSize) *OutFileSize = FileSize;
+	return true;
+}
+
+bool FTileMapFile::Load(const FString& Path, TArray<FString>& OutPalette, TFunctionRef<void(const FTileChunkData&)> ChunkVisitor, FString& OutError)
+{
+	// A buffered reader streams the file, so memory stays at one chunk however big the map is
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+	if (!Reader)
+	{
+		OutError = FString::Printf(TEXT("Can't open %s"), *Path);
+		return false;
+	}
+
+	FArchive& Ar = *Reader;
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	Ar << Magic << Version;
+	if (Ar.IsError() || Magic != FileMagic || Version > FileVersion)
+	{
+		OutError = TEXT("Not a tile map file, or a newer version");
+		return false;
+	}
+
+	uint32 NumPalette = 0;
+	Ar.SerializeIntPacked(NumPalette);
+	OutPalette.Reset();
+	for (uint32 i = 0; i < NumPalette && !Ar.IsError(); i++)
+	{
+		Ar << OutPalette.AddDefaulted_GetRef();
+	}
+
+	uint32 NumChunks = 0;
+	Ar.SerializeIntPacked(NumChunks);
+
+	FTileChunkData Chunk;
+	Chunk.Codes.Reserve(CellsPerChunk);
+	for (uint32 i = 0; i < NumChunks; i++)
+	{
+		EChunkEncoding Encoding = EChunkEncoding::RunLength;
+		Ar << Chunk.Coord << Encoding;
+
+		if (Ar.IsError() || !ReadChunkCodes(Ar, Encoding, Chunk.Codes))
+		{
+			OutError = FString::Printf(TEXT("Chunk %u is damaged or truncated"), i);
+			return false;
+		}
+
+		ChunkVisitor(Chunk);
+	}
+
+	return true;
+}
+
+// Usage: HW3.BenchmarkTileMapFile [Tiles=1000000] [Types=8] [Seed=1]
+static void BenchmarkTileMapFile(const TArray<FString>& Args)
+{
+	const int32 NumTiles = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000000);
+	const int32 NumTypes = FMath::Clamp(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 8, 1, 1000);
+	FRandomStream Random(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1);
+
+	// A filled square with patches of the same type, like a built-up map, and a sprinkling of rotated tiles
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt((float)NumTiles));
+	TArray<int16> PatchTypes;
+	const int32 PatchesPerSide = Side / 8 + 1;
+	PatchTypes.SetNumUninitialized(PatchesPerSide * PatchesPerSide);
+	for (int16& Type : PatchTypes) Type = Random.RandRange(0, NumTypes - 1);
+
+	FTileMap Map;
+	for (int32 i = 0; i < NumTiles; i++)
+	{
+		const FIntPoint Cell(i % Side - Side / 2, i / Side - Side / 2);
+		FTileCell Tile;
+		Tile.TileType = PatchTypes[((i / Side) / 8) * PatchesPerSide + (i % Side) / 8];
+		Tile.Rotation = Random.RandRange(0, 9) == 0 ? Random.RandRange(1, 3) : 0;
+		Map.Set(Cell, Tile);
+	}
+
+	TArray<FString> Palette;
+	for (int32 i = 0; i < NumTypes; i++) Palette.Add(FString::Printf(TEXT("Tile%d"), i));
+
+	const FString Path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TileMapBenchmark.tiles"));
+
+	double Start = FPlatformTime::Seconds();
+	const FTileMapFileData Data = FTileMapFile::Capture(Map, Palette);
+	const double CaptureSeconds = FPlatformTime::Seconds() - Start;
+
+	Start = FPlatformTime::Seconds();
+	int64 FileSize = 0;
+	const bool bSaved = FTileMapFile::Save(Data, Path, &FileSize);
+	const double SaveSeconds = FPlatformTime::Seconds() - Start;
+
+	Start = FPlatformTime::Seconds();
+	FTileMap Loaded;
+	TArray<FString> LoadedPalette;
+	FString Error;
+	const bool bLoaded = FTileMapFile::Load(Path, LoadedPalette, [&Loaded](const FTileChunkData& Chunk)
+	{
+		const FIntPoint Origin = Chunk.Coord * FTileMap::ChunkSize;
+		for (int32 Index = 0; Index < Chunk.Codes.Num(); Index++)
+		{
+			if (Chunk.Codes[Index] == 0) continue;
+			Loaded.Set(Origin + FIntPoint(Index & FTileMap::ChunkMask, Index >> FTileMap::ChunkShift), FTileMapFile::DecodeCell(Chunk.Codes[Index]));
+		}
+	}, Error);
+	const double LoadSeconds = FPlatformTime::Seconds() - Start;
+
+	IFileManager::Get().Delete(*Path);
+
+	UE_LOG(LogTemp, Warning, TEXT("Tile map file, %d tiles of %d types in %d chunks: %lld bytes (%.2f bytes/tile), capture %.1f ms, save %.1f ms, load %.1f ms, %d tiles loaded%s"),
+		Map.Num(), NumTypes, Map.NumChunks(), FileSize, (double)FileSize / Map.Num(), CaptureSeconds * 1000.0, SaveSeconds * 1000.0, LoadSeconds * 1000.0,
+		Loaded.Num(), bSaved && bLoaded && Loaded.Num() == Map.Num() ? TEXT("") : *FString::Printf(TEXT(" (FAILED %s)"), *Error));
+}
+
+static FAutoConsoleCommand BenchmarkTileMapFileCommand(
+	TEXT("HW3.BenchmarkTileMapFile"),
+	TEXT("Save and load a generated tile map and report file size and timings. Args: [Tiles=1000000] [Types=8] [Seed=1]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTileMapFile));
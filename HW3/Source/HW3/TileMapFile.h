@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TileMap.h"
+
+// One chunk of a tile map in file form. Each cell is a code: 0 for empty, otherwise
+// (palette index + 1) << 2 | rotation, row by row like FTileMap's chunks.
+struct FTileChunkData
+{
+	FIntPoint Coord;
+	TArray<uint16> Codes;
+};
+
+// A whole map captured for saving: plain data, so it can be written from any thread
+struct FTileMapFileData
+{
+	// Names of the tile types, by palette index
+	TArray<FString> Palette;
+	TArray<FTileChunkData> Chunks;
+	int32 NumTiles = 0;
+};
+
+/**
+ * Chunked binary tile map files. Chunks are stored one after another, each as either run-length
+ * encoded codes or codes bit-packed at the width of the largest one, whichever is smaller, so both
+ * large uniform areas and busy mixed areas stay compact. Loading streams the file one chunk at a time.
+ */
+class HW3_API FTileMapFile
+{
+public:
+	static uint16 EncodeCell(const FTileCell& Tile) { return Tile.IsEmpty() ? 0 : (uint16)(((Tile.TileType + 1) << 2) | (Tile.Rotation & 3)); }
+
+	// Inverse of EncodeCell; the instance index is left unset
+	static FTileCell DecodeCell(uint16 Code);
+
+	// Copy a map for saving; tile types index into Palette. Game thread, it reads the live map.
+	static FTileMapFileData Capture(const FTileMap& Map, const TArray<FString>& Palette);
+
+	// Write to a temporary file and move it over Path once complete. Safe on any thread.
+	static bool Save(const FTileMapFileData& Data, const FString& Path, int64* OutFileSize = nullptr);
+
+	// Read the palette, then call ChunkVisitor for each chunk as it is decoded. Safe on any thread.
+	static bool Load(const FString& Path, TArray<FString>& OutPalette, TFunctionRef<void(const FTileChunkData&)> ChunkVisitor, FString& OutError);
+};
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TileMapGenerator.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+void FTileMapGenerator::GenerateChunk(const FTileGeneratorSettings& Settings, const FIntPoint& ChunkCoord, FTileChunkData& OutChunk)
+{
+	// PerlinNoise2D has no seed of its own, so each seed samples a different far-off patch of it
+	FRandomStream Random(Settings.Seed);
+	const FVector2D LandOffset(Random.FRandRange(-10000.0f, 10000.0f), Random.FRandRange(-10000.0f, 10000.0f));
+	const FVector2D TypeOffset(Random.FRandRange(-10000.0f, 10000.0f), Random.FRandRange(-10000.0f, 10000.0f));
+
+	const float Frequency = 1.0f / FMath::Max(Settings.Scale, 1.0f);
+
+	// Noise is roughly -1 to 1, fairly evenly spread around 0
+	const float LandThreshold = FMath::Lerp(-0.5f, 0.5f, FMath::Clamp(Settings.EmptyFraction, 0.0f, 1.0f));
+
+	OutChunk.Coord = ChunkCoord;
+	OutChunk.Codes.SetNumZeroed(FTileMap::ChunkSize * FTileMap::ChunkSize);
+
+	const FIntPoint Origin = ChunkCoord * FTileMap::ChunkSize;
+	for (int32 Index = 0; Index < OutChunk.Codes.Num(); Index++)
+	{
+		const FIntPoint Cell = Origin + FIntPoint(Index & FTileMap::ChunkMask, Index >> FTileMap::ChunkShift);
+		if (Settings.Extent > 0 && (FMath::Abs(Cell.X) > Settings.Extent || FMath::Abs(Cell.Y) > Settings.Extent)) continue;
+
+		const FVector2D Position(Cell.X * Frequency, Cell.Y * Frequency);
+		const float Land = FMath::PerlinNoise2D(Position + LandOffset) + 0.5f * FMath::PerlinNoise2D(Position * 2.0f + LandOffset);
+		if (Land < LandThreshold) continue;
+
+		const float TypeNoise = FMath::PerlinNoise2D(Position * 0.5f + TypeOffset) * 0.5f + 0.5f;
+		const uint32 Hash = HashCombineFast(GetTypeHash(Cell), (uint32)Settings.Seed);
+
+		FTileCell Tile;
+		Tile.TileType = FMath::Clamp(FMath::FloorToInt(TypeNoise * Settings.NumTypes), 0, Settings.NumTypes - 1);
+		Tile.Rotation = Hash & 3;
+		OutChunk.Codes[Index] = FTileMapFile::EncodeCell(Tile);
+	}
+}
+
+TArray<FIntPoint> FTileMapGenerator::GetChunkCoords(const FTileGeneratorSettings& Settings)
+{
+	TArray<FIntPoint> Coords;
+	Coords.Reserve(4 * Settings.Radius * Settings.Radius);
+	for (int32 Y = -Settings.Radius; Y < Settings.Radius; Y++)
+	{
+		for (int32 X = -Settings.Radius; X < Settings.Radius; X++)
+		{
+			Coords.Add(FIntPoint(X, Y));
+		}
+	}
+	return Coords;
+}
+
+// Usage: HW3.BenchmarkTileGenerator [Radius=16] [Types=8] [Seed=1]
+// Generates chunks in parallel and on one thread, without placing anything, and reports tiles per second for each
+static void BenchmarkTileGenerator(const TArray<FString>& Args)
+{
+	FTileGeneratorSettings Settings;
+	Settings.Radius = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 16, 1, 256);
+	Settings.NumTypes = FMath::Clamp(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 8, 1, 1000);
+	Settings.Seed = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1;
+
+	const TArray<FIntPoint> Coords = FTileMapGenerator::GetChunkCoords(Settings);
+	TArray<FTileChunkData> Chunks;
+	Chunks.SetNum(Coords.Num());
+
+	auto CountTiles = [&Chunks]()
+	{
+		int64 NumTiles = 0;
+		for (const FTileChunkData& Chunk : Chunks)
+		{
+			for (uint16 Code : Chunk.Codes) NumTiles += Code != 0 ? 1 : 0;
+		}
+		return NumTiles;
+	};
+
+	double Start = FPlatformTime::Seconds();
+	ParallelFor(Coords.Num(), [&](int32 Index)
+	{
+		FTileMapGenerator::GenerateChunk(Settings, Coords[Index], Chunks[Index]);
+	});
+	const double ParallelSeconds = FPlatformTime::Seconds() - Start;
+	const int64 ParallelTiles = CountTiles();
+
+	Start = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < Coords.Num(); Index++)
+	{
+		FTileMapGenerator::GenerateChunk(Settings, Coords[Index], Chunks[Index]);
+	}
+	const double SerialSeconds = FPlatformTime::Seconds() - Start;
+
+	// Same settings must give the same map whichever thread made each chunk
+	const bool bDeterministic = CountTiles() == ParallelTiles;
+
+	UE_LOG(LogTemp, Warning, TEXT("Tile generator: %d chunks, %lld tiles; parallel %.1f ms (%.2fM tiles/s), one thread %.1f ms (%.2fM tiles/s)%s"),
+		Coords.Num(), ParallelTiles,
+		ParallelSeconds * 1000.0, ParallelTiles / FMath::Max(ParallelSeconds, 1e-9) / 1e6,
+		SerialSeconds * 1000.0, ParallelTiles / FMath::Max(SerialSeconds, 1e-9) / 1e6,
+		bDeterministic ? TEXT("") : TEXT(", tile counts differ between runs!"));
+}
+
+static FAutoConsoleCommand BenchmarkTileGeneratorCommand(
+	TEXT("HW3.BenchmarkTileGenerator"),
+	TEXT("Time procedural chunk generation in parallel and on one thread. Args: [Radius=16] [Types=8] [Seed=1]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTileGenerator));
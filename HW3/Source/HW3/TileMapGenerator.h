@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TileMapFile.h"
+
+struct FTileGeneratorSettings
+{
+	int32 Seed = 1;
+
+	// Chunks from -Radius to Radius - 1 on each axis are generated
+	int32 Radius = 4;
+
+	// Cells beyond this distance from the origin stay empty; 0 for no limit
+	int32 Extent = 0;
+
+	int32 NumTypes = 1;
+
+	// Cells per noise period; larger gives wider islands and regions
+	float Scale = 24.0f;
+
+	// Share of cells left empty, roughly
+	float EmptyFraction = 0.35f;
+};
+
+/**
+ * Fills tile map chunks from seeded Perlin noise: one noise field decides which cells hold land, a second,
+ * coarser one picks the tile type so types come in regions, and a hash of the cell picks the rotation.
+ * Every chunk depends only on the settings and its coordinate, so chunks can be generated in any order on any thread.
+ */
+class HW3_API FTileMapGenerator
+{
+public:
+	// Codes are as in FTileMapFile, with tile type indices in place of palette indices
+	static void GenerateChunk(const FTileGeneratorSettings& Settings, const FIntPoint& ChunkCoord, FTileChunkData& OutChunk);
+
+	// Every chunk in the settings' radius, in row order
+	static TArray<FIntPoint> GetChunkCoords(const FTileGeneratorSettings& Settings);
+};
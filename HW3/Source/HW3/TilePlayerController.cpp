@@ -3,10 +3,11 @@
 
 #include "TilePlayerController.h"
 #include "TileGameManager.h"
-#include "GameFramework/PlayerInput.h"
 
 // Sets default values
-ATilePlayerController::ATilePlayerController()
+ATilePlayerController::ATilePlayerController() : GameManager(nullptr), bTraceBuildPlane(false), TraceDistance(50000.0f),
+	LastMousePosition(FVector2D::ZeroVector), LastViewLocation(FVector::ZeroVector), LastViewRotation(FRotator::ZeroRotator),
+	LastViewportSize(0, 0), bCursorDirty(true)
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -21,27 +22,138 @@ void ATilePlayerController::BeginPlay()
 	bShowMouseCursor = true;	
 }
 
+void ATilePlayerController::SetupInputComponent()
+{
+	Super::SetupInputComponent();
+
+	InputComponent->BindKey(FInputChord(EKeys::Z, false, true, false, false), IE_Pressed, this, &ATilePlayerController::HandleUndoInput);
+	InputComponent->BindKey(EKeys::LeftMouseButton, IE_Pressed, this, &ATilePlayerController::HandlePlaceInput);
+	InputComponent->BindKey(EKeys::LeftMouseButton, IE_Released, this, &ATilePlayerController::HandlePlaceReleasedInput);
+	InputComponent->BindKey(EKeys::T, IE_Pressed, this, &ATilePlayerController::HandleToolInput);
+	InputComponent->BindKey(EKeys::MiddleMouseButton, IE_Pressed, this, &ATilePlayerController::HandleEraseInput);
+	InputComponent->BindKey(EKeys::MouseScrollDown, IE_Pressed, this, &ATilePlayerController::HandleNextTileInput);
+	InputComponent->BindKey(EKeys::MouseScrollUp, IE_Pressed, this, &ATilePlayerController::HandlePreviousTileInput);
+	InputComponent->BindKey(EKeys::RightMouseButton, IE_Pressed, this, &ATilePlayerController::HandleRotateInput);
+}
+
+void ATilePlayerController::HandleUndoInput()
+{
+	if (GameManager) GameManager->UndoLastEdit();
+}
+
+void ATilePlayerController::HandlePlaceInput()
+{
+	if (GameManager == nullptr) return;
+
+	// Input is processed before Tick, so catch up with a mouse move made this frame
+	UpdateCursor();
+	GameManager->BeginPlacement();
+}
+
+void ATilePlayerController::HandlePlaceReleasedInput()
+{
+	if (GameManager == nullptr) return;
+
+	UpdateCursor();
+	GameManager->EndPlacement();
+}
+
+void ATilePlayerController::HandleToolInput()
+{
+	if (GameManager) GameManager->SelectNextPlacementTool();
+}
+
+void ATilePlayerController::HandleEraseInput()
+{
+	if (GameManager == nullptr) return;
+
+	UpdateCursor();
+	GameManager->EraseTileAtCursor();
+}
+
+void ATilePlayerController::HandleNextTileInput()
+{
+	if (GameManager) GameManager->SelectTileType(1);
+}
+
+void ATilePlayerController::HandlePreviousTileInput()
+{
+	if (GameManager) GameManager->SelectTileType(-1);
+}
+
+void ATilePlayerController::HandleRotateInput()
+{
+	if (GameManager) GameManager->RotateCurrentTile();
+}
+
 // Called every frame
 void ATilePlayerController::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	UpdateCursor();
+}
+
+void ATilePlayerController::UpdateCursor()
+{
 	if (GameManager == nullptr) return;
 
-	FHitResult HitResult;
-	FVector WorldLocation, WorldDirection;
+	float MouseX, MouseY;
+	if (!GetMousePosition(MouseX, MouseY)) return;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	int32 ViewportX, ViewportY;
+	GetViewportSize(ViewportX, ViewportY);
 
-	if (DeprojectMousePositionToWorld(WorldLocation, WorldDirection))
+	const FVector2D MousePosition(MouseX, MouseY);
+	const FIntPoint ViewportSize(ViewportX, ViewportY);
+	if (!bCursorDirty && MousePosition == LastMousePosition && ViewLocation == LastViewLocation
+		&& ViewRotation == LastViewRotation && ViewportSize == LastViewportSize)
 	{
-		if (GWorld->LineTraceSingleByChannel(HitResult, WorldLocation, WorldLocation + WorldDirection * 50000.0f, ECC_Visibility))
-		{
-			AActor* HitActor = HitResult.GetActor();
-			GameManager->OnActorInteraction(HitActor, HitResult.Location, PlayerInput->IsPressed(EKeys::LeftMouseButton));
-		}
-		else
-		{
-			UE_LOG(LogTemp, Warning, TEXT("No Hit"));
-		}
+		return;
+	}
+
+	LastMousePosition = MousePosition;
+	LastViewLocation = ViewLocation;
+	LastViewRotation = ViewRotation;
+	LastViewportSize = ViewportSize;
+	bCursorDirty = false;
+
+	FVector Location;
+	if (TraceCursor(Location))
+	{
+		GameManager->SetCursorLocation(Location);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("No Hit"));
 	}
 }
 
+bool ATilePlayerController::TraceCursor(FVector& OutLocation) const
+{
+	FVector WorldLocation, WorldDirection;
+	if (!DeprojectMousePositionToWorld(WorldLocation, WorldDirection)) return false;
+
+	if (bTraceBuildPlane)
+	{
+		// Rays parallel to the plane or pointing away from it never reach it
+		if (FMath::IsNearlyZero(WorldDirection.Z)) return false;
+
+		const float PlaneHeight = GameManager ? GameManager->BuildPlaneHeight : 0.0f;
+		const float Distance = (PlaneHeight - WorldLocation.Z) / WorldDirection.Z;
+		if (Distance < 0.0f || Distance > TraceDistance) return false;
+
+		OutLocation = WorldLocation + WorldDirection * Distance;
+		return true;
+	}
+
+	FHitResult HitResult;
+	if (!GetWorld()->LineTraceSingleByChannel(HitResult, WorldLocation, WorldLocation + WorldDirection * TraceDistance, ECC_Visibility)) return false;
+
+	OutLocation = HitResult.Location;
+	return true;
+}
@@ -21,8 +21,40 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void SetupInputComponent() override;
+
+	void HandleUndoInput();
+	void HandlePlaceInput();
+	void HandlePlaceReleasedInput();
+	void HandleToolInput();
+	void HandleEraseInput();
+	void HandleNextTileInput();
+	void HandlePreviousTileInput();
+	void HandleRotateInput();
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 	ATileGameManager* GameManager;
+
+	// Intersect the cursor ray with the game manager's build plane instead of tracing against the world
+	UPROPERTY(EditAnywhere)
+	bool bTraceBuildPlane;
+
+	UPROPERTY(EditAnywhere)
+	float TraceDistance;
+
+	// Trace again on the next update even if the mouse and camera haven't moved, e.g. after the world under the cursor changed
+	void InvalidateCursor() { bCursorDirty = true; }
+
+private:
+	// Re-trace the cursor when the mouse, camera or viewport changed since the last trace
+	void UpdateCursor();
+	bool TraceCursor(FVector& OutLocation) const;
+
+	FVector2D LastMousePosition;
+	FVector LastViewLocation;
+	FRotator LastViewRotation;
+	FIntPoint LastViewportSize;
+	bool bCursorDirty;
 };
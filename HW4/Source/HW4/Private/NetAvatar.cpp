@@ -2,9 +2,12 @@
 
 
 #include "NetAvatar.h"
+#include "NetGameInstance.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerState.h"
+#include "Engine/NetConnection.h"
 
-ANetAvatar::ANetAvatar()
+ANetAvatar::ANetAvatar() : bBotControlled(false), BotForward(0.0f), BotRight(0.0f), BotTurn(0.0f), BotInputTimeLeft(0.0f), BotStatsTimeLeft(0.0f)
 {
 	SpringArm = CreateDefaultSubobject<USpringArmComponent>(TEXT("SpringArm"));
 	SpringArm->SetupAttachment(RootComponent);
@@ -21,6 +24,19 @@ void ANetAvatar::BeginPlay()
 	SpringArm->bUsePawnControlRotation = true;
 	bUseControllerRotationYaw = false;
 	GetCharacterMovement()->bOrientRotationToMovement = true;
+
+	const UNetGameInstance* GameInstance = GetGameInstance<UNetGameInstance>();
+	bBotControlled = GameInstance && GameInstance->IsBot();
+
+	// Bots launched together must not all walk the same way
+	BotRandom.Initialize(FPlatformProcess::GetCurrentProcessId() ^ (int32)FPlatformTime::Cycles());
+}
+
+void ANetAvatar::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bBotControlled && IsLocallyControlled() && GetController()) DriveBotInput(DeltaTime);
 }
 
 void ANetAvatar::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -48,4 +64,34 @@ void ANetAvatar::MoveRight(float Amount)
 	FRotator YawRotation(0.0f, Rotation.Yaw, 0.0f);
 	FVector RightDirection = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
 	AddMovementInput(RightDirection, Amount);
-}
\ No newline at end of file
+}
+
+void ANetAvatar::DriveBotInput(float DeltaTime)
+{
+	BotInputTimeLeft -= DeltaTime;
+	if (BotInputTimeLeft <= 0.0f)
+	{
+		BotForward = BotRandom.FRandRange(-1.0f, 1.0f);
+		BotRight = BotRandom.FRandRange(-1.0f, 1.0f);
+		BotTurn = BotRandom.FRandRange(-1.0f, 1.0f);
+		BotInputTimeLeft = BotRandom.FRandRange(1.0f, 4.0f);
+	}
+
+	MoveForward(BotForward);
+	MoveRight(BotRight);
+
+	// Scaled to about what a mouse gives per frame, so the camera swings like a player's would
+	AddControllerYawInput(BotTurn * DeltaTime * 60.0f);
+
+	BotStatsTimeLeft -= DeltaTime;
+	if (BotStatsTimeLeft > 0.0f) return;
+	BotStatsTimeLeft = 10.0f;
+
+	// What this bot sees of the server, to put next to HW4.NetStats on the server side
+	if (const UNetConnection* Connection = GetNetConnection())
+	{
+		UE_LOG(LogTemp, Log, TEXT("Bot stats: ping %.0f ms, in %d B/s, out %d B/s, in loss %.1f%%, out loss %.1f%%"),
+			GetPlayerState() ? GetPlayerState()->GetPingInMilliseconds() : 0.0f, Connection->InBytesPerSecond, Connection->OutBytesPerSecond,
+			Connection->GetInLossPercentage().GetAvgLossPercentage() * 100.0f, Connection->GetOutLossPercentage().GetAvgLossPercentage() * 100.0f);
+	}
+}
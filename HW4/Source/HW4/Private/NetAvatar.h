@@ -26,10 +26,22 @@ public:
 	UCameraComponent* Camera;
 
 	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaTime) override;
 	virtual void SetupPlayerInputComponent(UInputComponent* PlayerInputComponent) override;
 
 private:
 	void MoveForward(float Amount);
 	void MoveRight(float Amount);
 
+	// Stand-in for the axis bindings on bot clients: holds a random stick and turn for a few seconds, then picks another
+	void DriveBotInput(float DeltaTime);
+
+	bool bBotControlled;
+	FRandomStream BotRandom;
+	float BotForward;
+	float BotRight;
+	float BotTurn;
+	float BotInputTimeLeft;
+	float BotStatsTimeLeft;
+
 };
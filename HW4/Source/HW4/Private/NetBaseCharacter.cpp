@@ -2,20 +2,102 @@
 
 
 #include "NetBaseCharacter.h"
+#include "Net/UnrealNetwork.h"
+
+void FNetPackedMovement::Set(const FVector& InLocation, const FVector& InVelocity, float InYaw)
+{
+	Location = FIntVector(FMath::RoundToInt(InLocation.X), FMath::RoundToInt(InLocation.Y), FMath::RoundToInt(InLocation.Z));
+	Velocity = FIntVector(FMath::RoundToInt(InVelocity.X), FMath::RoundToInt(InVelocity.Y), FMath::RoundToInt(InVelocity.Z));
+	Yaw = FRotator::CompressAxisToShort(InYaw);
+}
+
+// Zig-zag, so small negative values pack as small as small positive ones
+static void SerializeSignedPacked(FArchive& Ar, int32& Value)
+{
+	uint32 Packed = (uint32)(Value << 1) ^ (uint32)(Value >> 31);
+	Ar.SerializeIntPacked(Packed);
+	if (Ar.IsLoading()) Value = (int32)(Packed >> 1) ^ -(int32)(Packed & 1);
+}
+
+bool FNetPackedMovement::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// A standing character skips its velocity, and a character on flat ground mostly has none vertically
+	uint8 bMoving = Velocity.X != 0 || Velocity.Y != 0;
+	uint8 bVertical = Velocity.Z != 0;
+	Ar.SerializeBits(&bMoving, 1);
+	Ar.SerializeBits(&bVertical, 1);
+
+	SerializeSignedPacked(Ar, Location.X);
+	SerializeSignedPacked(Ar, Location.Y);
+	SerializeSignedPacked(Ar, Location.Z);
+	Ar << Yaw;
+
+	if (Ar.IsLoading()) Velocity = FIntVector::ZeroValue;
+	if (bMoving)
+	{
+		SerializeSignedPacked(Ar, Velocity.X);
+		SerializeSignedPacked(Ar, Velocity.Y);
+	}
+	if (bVertical)
+	{
+		SerializeSignedPacked(Ar, Velocity.Z);
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
 
 // Sets default values
-ANetBaseCharacter::ANetBaseCharacter()
+ANetBaseCharacter::ANetBaseCharacter() : MovementNetUpdateFrequency(30.0f), MovementMinNetUpdateFrequency(5.0f), MovementNetPriority(3.0f)
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
 }
 
+void ANetBaseCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Movement still counts as replicated, so the engine's smoothing runs on proxies, but PackedMovement carries it
+	DISABLE_REPLICATED_PRIVATE_PROPERTY(AActor, ReplicatedMovement);
+	DOREPLIFETIME_CONDITION(ANetBaseCharacter, PackedMovement, COND_SimulatedOnly);
+}
+
+void ANetBaseCharacter::PreReplication(IChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	if (HasAuthority())
+	{
+		PackedMovement.Set(GetActorLocation(), GetVelocity(), GetActorRotation().Yaw);
+	}
+}
+
+void ANetBaseCharacter::OnRep_PackedMovement()
+{
+	// Hand it to the engine as if ReplicatedMovement had arrived, so proxies smooth and animate as before
+	FRepMovement& Movement = GetReplicatedMovement_Mutable();
+	Movement.Location = PackedMovement.GetLocation();
+	Movement.Rotation = FRotator(0.0f, PackedMovement.GetYaw(), 0.0f);
+	Movement.LinearVelocity = PackedMovement.GetVelocity();
+	Movement.AngularVelocity = FVector::ZeroVector;
+	Movement.bRepPhysics = false;
+
+	OnRep_ReplicatedMovement();
+}
+
 // Called when the game starts or when spawned
 void ANetBaseCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	if (HasAuthority())
+	{
+		NetUpdateFrequency = MovementNetUpdateFrequency;
+		MinNetUpdateFrequency = MovementMinNetUpdateFrequency;
+		NetPriority = MovementNetPriority;
+	}
 }
 
 // Called every frame
@@ -31,4 +113,3 @@ void ANetBaseCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
 
 }
-
@@ -6,7 +6,49 @@
 #include "GameFramework/Character.h"
 #include "NetBaseCharacter.generated.h"
 
-UCLASS()
+/**
+ * What simulated proxies need of a character's movement, quantized to whole centimetres and a 16-bit yaw and
+ * written with packed integers, so a character standing near the origin costs a few bytes instead of a full
+ * FRepMovement. Only yaw is sent; these characters never pitch or roll.
+ */
+USTRUCT()
+struct FNetPackedMovement
+{
+	GENERATED_BODY()
+
+	FIntVector Location = FIntVector::ZeroValue;
+
+	// cm/s
+	FIntVector Velocity = FIntVector::ZeroValue;
+
+	uint16 Yaw = 0;
+
+	void Set(const FVector& InLocation, const FVector& InVelocity, float InYaw);
+
+	FVector GetLocation() const { return FVector(Location); }
+	FVector GetVelocity() const { return FVector(Velocity); }
+	float GetYaw() const { return FRotator::DecompressAxisFromShort(Yaw); }
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FNetPackedMovement& Other) const
+	{
+		return Location == Other.Location && Velocity == Other.Velocity && Yaw == Other.Yaw;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FNetPackedMovement> : public TStructOpsTypeTraitsBase2<FNetPackedMovement>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		// The replication system compares with this to decide whether to send the struct at all
+		WithIdenticalViaEquality = true
+	};
+};
+
+UCLASS(Config = Game)
 class ANetBaseCharacter : public ACharacter
 {
 	GENERATED_BODY()
@@ -15,10 +57,30 @@ public:
 	// Sets default values for this character's properties
 	ANetBaseCharacter();
 
+	// How often the server considers sending this character, and how it ranks against other actors when bandwidth is short
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Network")
+	float MovementNetUpdateFrequency;
+
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Network")
+	float MovementMinNetUpdateFrequency;
+
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Network")
+	float MovementNetPriority;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IChangedPropertyTracker& ChangedPropertyTracker) override;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Replaces ReplicatedMovement for simulated proxies
+	UPROPERTY(ReplicatedUsing = OnRep_PackedMovement)
+	FNetPackedMovement PackedMovement;
+
+	UFUNCTION()
+	void OnRep_PackedMovement();
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -2,6 +2,8 @@
 
 
 #include "NetGameInstance.h"
+#include "Engine/Engine.h"
+#include "Engine/PendingNetGame.h"
 
 void UNetGameInstance::host(FString MapName)
 {
@@ -13,4 +15,31 @@ void UNetGameInstance::join(FString Address)
 {
 	GEngine->AddOnScreenDebugMessage(0, 1.0f, FColor::Red, TEXT("Joining Game..."));
 	GWorld->GetFirstPlayerController()->ClientTravel(Address, ETravelType::TRAVEL_Absolute);
-}
\ No newline at end of file
+}
+
+void UNetGameInstance::Init()
+{
+	Super::Init();
+
+	bIsBot = FParse::Param(FCommandLine::Get(), TEXT("bot"));
+	if (bIsBot && !FParse::Value(FCommandLine::Get(), TEXT("botserver="), BotServerAddress))
+	{
+		BotServerAddress = TEXT("127.0.0.1");
+	}
+}
+
+void UNetGameInstance::OnStart()
+{
+	Super::OnStart();
+
+	// Clients given a server on the command line are already connecting
+	if (!bIsBot || GetWorld()->GetNetMode() != NM_Standalone || GetWorldContext()->PendingNetGame) return;
+
+	UE_LOG(LogTemp, Log, TEXT("Bot joining %s"), *BotServerAddress);
+
+	// The player controller join travels with isn't spawned until the world has ticked once
+	GetTimerManager().SetTimerForNextTick([this]()
+	{
+		join(BotServerAddress);
+	});
+}
@@ -20,4 +20,15 @@ public:
 
 	UFUNCTION(BlueprintCallable)
 	void join(FString Address);
+
+	virtual void Init() override;
+	virtual void OnStart() override;
+
+	// Started with -bot: joins -botserver= (127.0.0.1 by default) on its own and plays with generated input,
+	// for load testing with many -nullrhi clients
+	bool IsBot() const { return bIsBot; }
+
+private:
+	bool bIsBot = false;
+	FString BotServerAddress;
 };
@@ -3,8 +3,115 @@
 
 #include "NetGameMode.h"
 #include "NetBaseCharacter.h"
+#include "NetReplicationGraph.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/Engine.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
 
 ANetGameMode::ANetGameMode()
 {
 	DefaultPawnClass = ANetBaseCharacter::StaticClass();
-}
\ No newline at end of file
+}
+
+// Usage: HW4.NetStats
+// Run on the server, e.g. a listen server with a client joined over loopback, to see what each player costs
+static void LogNetStats(const TArray<FString>& Args, UWorld* World)
+{
+	int32 NumPlayers = 0;
+	int64 TotalOutBytes = 0;
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		const UNetConnection* Connection = PlayerController ? PlayerController->GetNetConnection() : nullptr;
+
+		// The listen server's own player has no connection
+		if (Connection == nullptr || PlayerController->IsLocalController()) continue;
+
+		UE_LOG(LogTemp, Warning, TEXT("%s: out %d B/s, in %d B/s, out loss %.1f%%, ping %.0f ms"),
+			*Connection->LowLevelGetRemoteAddress(true), Connection->OutBytesPerSecond, Connection->InBytesPerSecond,
+			Connection->GetOutLossPercentage().GetAvgLossPercentage() * 100.0f, Connection->AvgLag * 1000.0);
+
+		NumPlayers++;
+		TotalOutBytes += Connection->OutBytesPerSecond;
+	}
+
+	// The frame time includes waiting for the next tick when the tick rate is capped, so report the work separately
+	const double WorkMs = FMath::Max(0.0, FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.0;
+	UE_LOG(LogTemp, Warning, TEXT("%d remote players, %lld B/s out in total, %.0f B/s per player, server game thread %.2f ms of a %.2f ms frame"),
+		NumPlayers, TotalOutBytes, NumPlayers > 0 ? (double)TotalOutBytes / NumPlayers : 0.0, WorkMs, GAverageMS);
+
+	const UNetDriver* NetDriver = World->GetNetDriver();
+	if (const UNetReplicationGraph* Graph = NetDriver ? Cast<UNetReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Replication graph: %.3f ms per frame, %.1f us per player"),
+			Graph->GetAverageReplicateMs(), NumPlayers > 0 ? Graph->GetAverageReplicateMs() * 1000.0 / NumPlayers : 0.0);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs NetStatsCommand(
+	TEXT("HW4.NetStats"),
+	TEXT("Log bandwidth, loss and ping of every remote player connected to this server"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&LogNetStats));
+
+static TArray<FProcHandle> LoadTestClients;
+
+// Usage: HW4.LaunchClients [Count=8] [ExtraArgs...]
+// Pass -bot to have them walk around. Starts headless clients of this executable that join the server running in this process over loopback
+static void LaunchClients(const TArray<FString>& Args, UWorld* World)
+{
+	if (World->GetNetMode() != NM_ListenServer && World->GetNetMode() != NM_DedicatedServer)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("HW4.LaunchClients needs a running server"));
+		return;
+	}
+
+	const int32 Count = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 8, 1, 256);
+
+	FString ExtraArgs;
+	for (int32 i = 1; i < Args.Num(); i++)
+	{
+		ExtraArgs += TEXT(" ") + Args[i];
+	}
+
+	// Editor and uncooked builds need to be told which project to run
+	const FString Project = FPlatformProperties::RequiresCookedData() || !FPaths::IsProjectFilePathSet() ? FString() : FString::Printf(TEXT("\"%s\" "), *FPaths::GetProjectFilePath());
+	const FString Game = GIsEditor ? TEXT(" -game") : FString();
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FString Params = FString::Printf(TEXT("%s127.0.0.1:%d%s -nullrhi -nosound -unattended -log=LoadClient%d.log%s"),
+			*Project, World->URL.Port, *Game, LoadTestClients.Num(), *ExtraArgs);
+
+		FProcHandle Handle = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *Params, true, true, true, nullptr, 0, nullptr, nullptr);
+		if (Handle.IsValid()) LoadTestClients.Add(Handle);
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("%d load test clients running; HW4.NetStats shows the cost per player"), LoadTestClients.Num());
+}
+
+// Usage: HW4.StopClients
+static void StopClients(const TArray<FString>& Args)
+{
+	for (FProcHandle& Handle : LoadTestClients)
+	{
+		FPlatformProcess::TerminateProc(Handle);
+		FPlatformProcess::CloseProc(Handle);
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Stopped %d load test clients"), LoadTestClients.Num());
+	LoadTestClients.Reset();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LaunchClientsCommand(
+	TEXT("HW4.LaunchClients"),
+	TEXT("Start headless clients that join this server over loopback. Args: [Count=8] [ExtraArgs...]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&LaunchClients));
+
+static FAutoConsoleCommand StopClientsCommand(
+	TEXT("HW4.StopClients"),
+	TEXT("Stop the clients started by HW4.LaunchClients"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&StopClients));
@@ -0,0 +1,267 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NetReplicationGraph.h"
+#include "NetBaseCharacter.h"
+#include "ReplicationGraphTypes.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerState.h"
+#include "UObject/UObjectIterator.h"
+
+UNetReplicationGraph::UNetReplicationGraph() : GridCellSize(10000.0f), SpatialBiasX(-150000.0f), SpatialBiasY(-200000.0f),
+	CharacterCullDistance(15000.0f), PlayerStateBuckets(3), GridNode(nullptr), AlwaysRelevantNode(nullptr), PlayerStateNode(nullptr),
+	AverageReplicateMs(0), LastReplicateMs(0)
+{
+}
+
+void UNetReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+		if (!ActorCDO || !ActorCDO->GetIsReplicated()) continue;
+
+		// Blueprint compile leftovers
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_"))) continue;
+
+		const EClassRepNodeMapping Policy = GetClassMapping(Class);
+		ClassRepNodePolicies.Set(Class, Policy);
+
+		FClassReplicationInfo ClassInfo;
+		InitClassReplicationInfo(ClassInfo, Class, Policy >= EClassRepNodeMapping::Spatialize_Static);
+
+		// Characters set their update rate at BeginPlay from config, which the CDO doesn't see
+		if (const ANetBaseCharacter* CharacterCDO = Cast<ANetBaseCharacter>(ActorCDO))
+		{
+			ClassInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(CharacterCDO->MovementNetUpdateFrequency);
+			ClassInfo.SetCullDistanceSquared(CharacterCullDistance * CharacterCullDistance);
+		}
+
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+void UNetReplicationGraph::InitGlobalGraphNodes()
+{
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = FVector2D(SpatialBiasX, SpatialBiasY);
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+
+	PlayerStateNode = CreateNewNode<UNetReplicationGraphNode_ConnectionBuckets>();
+	PlayerStateNode->SetNumBuckets(PlayerStateBuckets);
+	AddGlobalGraphNode(PlayerStateNode);
+}
+
+void UNetReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* Node = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(Node, RepGraphConnection);
+	OwnerNodes.Add({ RepGraphConnection->NetConnection, Node });
+}
+
+void UNetReplicationGraph::RemoveClientConnection(UNetConnection* NetConnection)
+{
+	OwnerNodes.RemoveAllSwap([NetConnection](const FConnectionOwnerNode& Pair) { return Pair.NetConnection == NetConnection; });
+
+	Super::RemoveClientConnection(NetConnection);
+}
+
+UReplicationGraphNode_AlwaysRelevant_ForConnection* UNetReplicationGraph::GetOwnerNodeForConnection(UNetConnection* Connection)
+{
+	const FConnectionOwnerNode* Pair = OwnerNodes.FindByPredicate([Connection](const FConnectionOwnerNode& It) { return It.NetConnection == Connection; });
+	return Pair ? Pair->Node : nullptr;
+}
+
+void UNetReplicationGraphNode_ConnectionBuckets::SetNumBuckets(int32 NumBuckets)
+{
+	Buckets.SetNum(FMath::Max(1, NumBuckets));
+}
+
+void UNetReplicationGraphNode_ConnectionBuckets::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
+{
+	if (Buckets.Num() == 0) SetNumBuckets(1);
+
+	// Smallest bucket, keeping them even as players join and leave
+	int32 Smallest = 0;
+	for (int32 Index = 1; Index < Buckets.Num(); Index++)
+	{
+		if (Buckets[Index].Num() < Buckets[Smallest].Num()) Smallest = Index;
+	}
+	Buckets[Smallest].Add(ActorInfo.Actor);
+}
+
+bool UNetReplicationGraphNode_ConnectionBuckets::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound)
+{
+	for (FActorRepListRefView& Bucket : Buckets)
+	{
+		if (Bucket.RemoveFast(ActorInfo.Actor)) return true;
+	}
+
+	UE_CLOG(bWarnIfNotFound, LogTemp, Warning, TEXT("%s not found in player state buckets"), *GetNameSafe(ActorInfo.Actor));
+	return false;
+}
+
+void UNetReplicationGraphNode_ConnectionBuckets::NotifyResetAllNetworkActors()
+{
+	for (FActorRepListRefView& Bucket : Buckets)
+	{
+		Bucket.Reset();
+	}
+}
+
+void UNetReplicationGraphNode_ConnectionBuckets::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	if (Buckets.Num() == 0) return;
+
+	const int32 Index = (int32)((Params.ReplicationFrameNum + (uint32)Params.ConnectionManager.ConnectionOrderNum) % (uint32)Buckets.Num());
+	if (Buckets[Index].Num() > 0)
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(Buckets[Index]);
+	}
+}
+
+EClassRepNodeMapping UNetReplicationGraph::GetClassMapping(const UClass* Class)
+{
+	const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+	if (!ActorCDO || !ActorCDO->GetIsReplicated()) return EClassRepNodeMapping::NotRouted;
+
+	// Player states are always relevant too, but go in their buckets rather than to everyone every frame
+	if (Class->IsChildOf(APlayerState::StaticClass())) return EClassRepNodeMapping::PlayerState;
+	if (ActorCDO->bAlwaysRelevant) return EClassRepNodeMapping::AlwaysRelevant;
+	if (ActorCDO->bOnlyRelevantToOwner) return EClassRepNodeMapping::OwnerOnly;
+
+	// The grid follows dormancy changes by itself, so the class default is only where an actor starts out
+	const USceneComponent* Root = ActorCDO->GetRootComponent();
+	if (Root && Root->Mobility == EComponentMobility::Static) return EClassRepNodeMapping::Spatialize_Static;
+	return ActorCDO->NetDormancy > DORM_Awake ? EClassRepNodeMapping::Spatialize_Dormancy : EClassRepNodeMapping::Spatialize_Dynamic;
+}
+
+EClassRepNodeMapping UNetReplicationGraph::GetMappingPolicy(UClass* Class)
+{
+	// Classes loaded after startup inherit their parent's policy, or get their own if no parent is routed
+	if (const EClassRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class)) return *Policy;
+
+	const EClassRepNodeMapping Policy = GetClassMapping(Class);
+	ClassRepNodePolicies.Set(Class, Policy);
+	return Policy;
+}
+
+// Routing goes by class, not by flags an actor can change while replicated, so adding and removing agree
+void UNetReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	AActor* Actor = ActorInfo.Actor;
+
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+		case EClassRepNodeMapping::PlayerState:
+			PlayerStateNode->NotifyAddNetworkActor(ActorInfo);
+			break;
+
+		case EClassRepNodeMapping::AlwaysRelevant:
+			AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+			break;
+
+		case EClassRepNodeMapping::OwnerOnly:
+		{
+			// The owner's connection may not be set up yet, e.g. a controller spawned during login
+			UReplicationGraphNode_AlwaysRelevant_ForConnection* Node = Actor->GetNetConnection() ? GetOwnerNodeForConnection(Actor->GetNetConnection()) : nullptr;
+			if (Node)
+			{
+				Node->NotifyAddNetworkActor(ActorInfo);
+			}
+			else
+			{
+				ActorsWithoutConnection.Add(Actor);
+			}
+			break;
+		}
+
+		case EClassRepNodeMapping::Spatialize_Static:
+			GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+			break;
+
+		case EClassRepNodeMapping::Spatialize_Dormancy:
+			GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+			break;
+
+		case EClassRepNodeMapping::Spatialize_Dynamic:
+			GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void UNetReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	AActor* Actor = ActorInfo.Actor;
+
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+		case EClassRepNodeMapping::PlayerState:
+			PlayerStateNode->NotifyRemoveNetworkActor(ActorInfo);
+			break;
+
+		case EClassRepNodeMapping::AlwaysRelevant:
+			AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+			break;
+
+		case EClassRepNodeMapping::OwnerOnly:
+			if (ActorsWithoutConnection.RemoveSwap(Actor) == 0)
+			{
+				if (UReplicationGraphNode_AlwaysRelevant_ForConnection* Node = GetOwnerNodeForConnection(Actor->GetNetConnection()))
+				{
+					Node->NotifyRemoveNetworkActor(ActorInfo);
+				}
+			}
+			break;
+
+		case EClassRepNodeMapping::Spatialize_Static:
+			GridNode->RemoveActor_Static(ActorInfo);
+			break;
+
+		case EClassRepNodeMapping::Spatialize_Dormancy:
+			GridNode->RemoveActor_Dormancy(ActorInfo);
+			break;
+
+		case EClassRepNodeMapping::Spatialize_Dynamic:
+			GridNode->RemoveActor_Dynamic(ActorInfo);
+			break;
+
+		default:
+			break;
+	}
+}
+
+int32 UNetReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	const double Start = FPlatformTime::Seconds();
+
+	for (int32 Index = ActorsWithoutConnection.Num() - 1; Index >= 0; Index--)
+	{
+		AActor* Actor = ActorsWithoutConnection[Index];
+		UNetConnection* Connection = Actor ? Actor->GetNetConnection() : nullptr;
+		UReplicationGraphNode_AlwaysRelevant_ForConnection* Node = Connection ? GetOwnerNodeForConnection(Connection) : nullptr;
+		if (Actor && Node == nullptr) continue;
+
+		if (Node) Node->NotifyAddNetworkActor(FNewReplicatedActorInfo(Actor));
+		ActorsWithoutConnection.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	}
+
+	const int32 Result = Super::ServerReplicateActors(DeltaSeconds);
+
+	// Smoothed over roughly the last 30 frames
+	LastReplicateMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+	AverageReplicateMs = FMath::Lerp(AverageReplicateMs, LastReplicateMs, 1.0 / 30.0);
+	return Result;
+}
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "NetReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_AlwaysRelevant_ForConnection;
+
+/**
+ * Splits its actors into buckets and gives each connection one bucket per frame. Connections start at different
+ * buckets, so on any frame the work is spread over all buckets instead of every connection taking the same one.
+ */
+UCLASS()
+class UNetReplicationGraphNode_ConnectionBuckets : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	void SetNumBuckets(int32 NumBuckets);
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound = true) override;
+	virtual void NotifyResetAllNetworkActors() override;
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+private:
+	TArray<FActorRepListRefView> Buckets;
+};
+
+// Which node actors of a class go to; decided once per class so adding and removing an actor always agree
+enum class EClassRepNodeMapping : uint8
+{
+	NotRouted,
+	AlwaysRelevant,
+	PlayerState,
+	OwnerOnly,
+
+	// Grid mappings, kept last so they can be told apart by comparison
+	Spatialize_Static,
+	Spatialize_Dynamic,
+	Spatialize_Dormancy
+};
+
+USTRUCT()
+struct FConnectionOwnerNode
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UNetConnection* NetConnection = nullptr;
+
+	UPROPERTY()
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* Node = nullptr;
+};
+
+/**
+ * Replaces the default replication driver, which checks every actor against every connection each frame.
+ * Characters and other moving actors go in a 2D grid, so a connection only looks at the cells around its viewer;
+ * always relevant actors such as the game state go in one list shared by everyone; player states are spread over
+ * buckets so each connection only considers a slice of them each frame; and actors only relevant to their owner,
+ * like player controllers, go in a node belonging to that connection.
+ */
+UCLASS(Transient, Config = Engine)
+class UNetReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UNetReplicationGraph();
+
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RemoveClientConnection(UNetConnection* NetConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	// Average time ServerReplicateActors took over recent frames
+	double GetAverageReplicateMs() const { return AverageReplicateMs; }
+	double GetLastReplicateMs() const { return LastReplicateMs; }
+
+	UPROPERTY(Config)
+	float GridCellSize;
+
+	// Lowest world X and Y the grid expects; actors beyond still work, the grid just grows
+	UPROPERTY(Config)
+	float SpatialBiasX;
+
+	UPROPERTY(Config)
+	float SpatialBiasY;
+
+	// How far away other players' characters stay relevant
+	UPROPERTY(Config)
+	float CharacterCullDistance;
+
+	// Player states are split into this many buckets; each connection considers one bucket per frame
+	UPROPERTY(Config)
+	int32 PlayerStateBuckets;
+
+private:
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* GetOwnerNodeForConnection(UNetConnection* Connection);
+
+	static EClassRepNodeMapping GetClassMapping(const UClass* Class);
+	EClassRepNodeMapping GetMappingPolicy(UClass* Class);
+
+	TClassMap<EClassRepNodeMapping> ClassRepNodePolicies;
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+	UPROPERTY()
+	UNetReplicationGraphNode_ConnectionBuckets* PlayerStateNode;
+
+	UPROPERTY()
+	TArray<FConnectionOwnerNode> OwnerNodes;
+
+	// Owner-only actors whose owner has no connection yet; routed once it does
+	UPROPERTY()
+	TArray<AActor*> ActorsWithoutConnection;
+
+	double AverageReplicateMs;
+	double LastReplicateMs;
+};
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NetServerGameMode.h"
+#include "NetReplicationGraph.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetworkObjectList.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+ANetServerGameMode::ANetServerGameMode() : ServerTickRate(30), bWriteStatsCsv(true), StatsLogInterval(10.0f), StatsCsv(nullptr),
+	StatsStartTime(0), LoggedTicks(0), LoggedWorkMs(0), LoggedReplicateMs(0), MaxWorkMs(0), StatsLogTimeLeft(0.0f)
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Last in the frame, after everything else it measures has ticked
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+}
+
+void ANetServerGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetNetMode() != NM_DedicatedServer) return;
+
+	// The net driver exists once the server is listening, which is before actors begin play
+	FParse::Value(FCommandLine::Get(), TEXT("servertickrate="), ServerTickRate);
+	if (UNetDriver* NetDriver = GetWorld()->GetNetDriver())
+	{
+		NetDriver->SetNetServerMaxTickRate(FMath::Max(1, ServerTickRate));
+	}
+	UE_LOG(LogTemp, Log, TEXT("Dedicated server ticking at %d Hz"), ServerTickRate);
+
+	if (bWriteStatsCsv)
+	{
+		const FString Path = FPaths::Combine(FPaths::ProfilingDir(), FString::Printf(TEXT("ServerStats-%s.csv"), *FDateTime::Now().ToString()));
+		StatsCsv = IFileManager::Get().CreateFileWriter(*Path);
+		if (StatsCsv)
+		{
+			const FTCHARToUTF8 Header(TEXT("Time,WorkMs,TickIntervalMs,ReplicateMs,Connections,Actors,ReplicatedActors\n"));
+			StatsCsv->Serialize((void*)Header.Get(), Header.Length());
+			UE_LOG(LogTemp, Log, TEXT("Writing server stats to %s"), *Path);
+		}
+	}
+
+	StatsStartTime = FPlatformTime::Seconds();
+	StatsLogTimeLeft = StatsLogInterval;
+}
+
+void ANetServerGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (StatsCsv)
+	{
+		StatsCsv->Close();
+		delete StatsCsv;
+		StatsCsv = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ANetServerGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (GetNetMode() != NM_DedicatedServer || NetDriver == nullptr) return;
+
+	// Replication runs after the world ticks, so this is the previous frame's
+	const UNetReplicationGraph* Graph = Cast<UNetReplicationGraph>(NetDriver->GetReplicationDriver());
+	const double ReplicateMs = Graph ? Graph->GetLastReplicateMs() : 0.0;
+
+	// At a capped tick rate the delta is the tick period whatever the load; the work is the part not spent waiting
+	// for the next tick. Like replication, that wait ended this frame, so this is the previous frame's work
+	const double WorkMs = FMath::Max(0.0, FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.0;
+	const double TickIntervalMs = DeltaSeconds * 1000.0;
+	const int32 NumConnections = NetDriver->ClientConnections.Num();
+	const int32 NumActors = GetWorld()->GetActorCount();
+	const int32 NumReplicated = NetDriver->GetNetworkObjectList().GetAllObjects().Num();
+
+	if (StatsCsv)
+	{
+		const FTCHARToUTF8 Row(*FString::Printf(TEXT("%.3f,%.3f,%.3f,%.3f,%d,%d,%d\n"),
+			FPlatformTime::Seconds() - StatsStartTime, WorkMs, TickIntervalMs, ReplicateMs, NumConnections, NumActors, NumReplicated));
+		StatsCsv->Serialize((void*)Row.Get(), Row.Length());
+	}
+
+	LoggedTicks++;
+	LoggedWorkMs += WorkMs;
+	LoggedReplicateMs += ReplicateMs;
+	MaxWorkMs = FMath::Max(MaxWorkMs, WorkMs);
+
+	if (StatsLogInterval <= 0.0f) return;
+
+	StatsLogTimeLeft -= DeltaSeconds;
+	if (StatsLogTimeLeft > 0.0f) return;
+	StatsLogTimeLeft = StatsLogInterval;
+
+	UE_LOG(LogTemp, Log, TEXT("Server: %d connections, %d actors (%d replicated); game thread %.2f ms avg, %.2f ms max of a %.1f ms tick; replication %.3f ms avg"),
+		NumConnections, NumActors, NumReplicated, LoggedWorkMs / LoggedTicks, MaxWorkMs, 1000.0 / FMath::Max(1, ServerTickRate), LoggedReplicateMs / LoggedTicks);
+
+	if (StatsCsv) StatsCsv->Flush();
+
+	LoggedTicks = 0;
+	LoggedWorkMs = 0;
+	LoggedReplicateMs = 0;
+	MaxWorkMs = 0;
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NetGameMode.h"
+#include "NetServerGameMode.generated.h"
+
+class FArchive;
+
+/**
+ * Game mode for the dedicated server target. Runs the server at a fixed tick rate and records, every tick, how long
+ * the game thread worked (not the tick period, which the cap keeps constant) and how long replication took and how many connections and actors there were, to a CSV under Saved/Profiling
+ * and as a periodic log line, to size servers from real runs.
+ */
+UCLASS(Config = Game)
+class ANetServerGameMode : public ANetGameMode
+{
+	GENERATED_BODY()
+
+public:
+	ANetServerGameMode();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Server ticks per second; -servertickrate= on the command line overrides it
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Server")
+	int32 ServerTickRate;
+
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Server")
+	bool bWriteStatsCsv;
+
+	// Seconds between summary log lines; 0 for none
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Server")
+	float StatsLogInterval;
+
+private:
+	FArchive* StatsCsv;
+	double StatsStartTime;
+
+	// Totals since the last summary log line
+	int32 LoggedTicks;
+	double LoggedWorkMs;
+	double LoggedReplicateMs;
+	double MaxWorkMs;
+	float StatsLogTimeLeft;
+};